@@ -0,0 +1,477 @@
+#include "../include/memory.h"
+#include "../include/event_sink.h"
+#include "../include/buddy/buddy.h"
+#include "../include/slab/slab.h"
+#include "../include/cache/cache.h"
+#include "../include/cache/hierarchy.h"
+#include "../include/cache/replacement.h"
+#include "../include/virtual_memory/vm.h"
+#include "../include/workload/generator.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+// ================= Benchmarks =================
+// Times the simulator's hot paths on generated workloads (generator.h):
+// every allocator, every cache policy on a few geometries, and address
+// translation. Each workload is generated once up front, so only the
+// component under test is timed. Every repetition starts it from a
+// fresh state; an untimed first run warms the caches and the allocators'
+// own memory, and the median timed repetition is reported, which one
+// lucky or unlucky run cannot move.
+
+struct Result {
+    std::string name;
+    size_t ops;
+    double nsPerOp;
+};
+
+struct Options {
+    std::string filter;         // only names containing it
+    size_t repeat;
+    std::string output;         // results JSON
+    std::string baseline;       // baseline JSON to compare against
+    double threshold;           // % slower than the baseline that fails
+};
+
+// results fold into this so the timed loops cannot be optimised away
+static volatile size_t checksum;
+
+// runs setup() then run() once to warm up, then `repeat` more times
+// timed; median ns per op
+template <typename Setup, typename Run>
+Result measure(const std::string& name, size_t ops, size_t repeat,
+               Setup setup, Run run) {
+    setup();
+    run();
+
+    std::vector<double> samples;
+    for (size_t r = 0; r < repeat; r++) {
+        setup();
+        auto start = std::chrono::steady_clock::now();
+        run();
+        double seconds = std::chrono::duration<double>(
+            std::chrono::steady_clock::now() - start).count();
+        samples.push_back(seconds * 1e9 / ops);
+    }
+    std::sort(samples.begin(), samples.end());
+    return {name, ops, samples[samples.size() / 2]};
+}
+
+// ---------- Workloads ----------
+static const size_t ALLOC_OPS = 200000;
+static const size_t ACCESS_OPS = 1000000;
+
+// malloc / free only: power-law sizes, long-lived churn around 4096
+// live blocks
+std::vector<TraceRecord> allocatorWorkload(TraceOp init, size_t heap) {
+    WorkloadConfig config;
+    config.ops = ALLOC_OPS;
+    config.init = init;
+    config.heapSize = heap;
+    config.accessRatio = 0;
+
+    std::vector<TraceRecord> records;
+    WorkloadGenerator generator(config);
+    TraceRecord record;
+    while (generator.next(record)) {
+        if (record.op == TraceOp::MALLOC || record.op == TraceOp::FREE)
+            records.push_back(record);
+    }
+    return records;
+}
+
+// reads and writes only: Zipf (0.99) over the lines of `footprint` bytes
+std::vector<TraceRecord> accessWorkload(size_t footprint) {
+    WorkloadConfig config;
+    config.ops = ACCESS_OPS;
+    config.heapSize = footprint;
+    config.accessRatio = 1;
+
+    std::vector<TraceRecord> records;
+    WorkloadGenerator generator(config);
+    TraceRecord record;
+    while (generator.next(record)) {
+        if (record.op == TraceOp::READ || record.op == TraceOp::WRITE)
+            records.push_back(record);
+    }
+    return records;
+}
+
+// ---------- Allocators ----------
+template <typename Allocator>
+void runAllocator(Allocator& allocator,
+                  const std::vector<TraceRecord>& records) {
+    for (const TraceRecord& record : records) {
+        if (record.op == TraceOp::MALLOC)
+            allocator.mallocBlock(record.arg);
+        else
+            allocator.freeBlock(static_cast<int>(record.arg));
+    }
+}
+
+void benchAllocators(const Options& options, std::vector<Result>& results) {
+    static const size_t HEAP = 64 << 20;
+    static const AllocatorType TYPES[] = {
+        AllocatorType::FIRST_FIT, AllocatorType::BEST_FIT,
+        AllocatorType::WORST_FIT, AllocatorType::TLSF
+    };
+    static const char* NAMES[] = {
+        "first_fit", "best_fit", "worst_fit", "tlsf"
+    };
+    NullSink quiet;
+
+    std::vector<TraceRecord> records =
+        allocatorWorkload(TraceOp::INIT_MEMORY, HEAP);
+    for (size_t i = 0; i < 4; i++) {
+        std::string name = std::string("allocator/") + NAMES[i];
+        if (name.find(options.filter) == std::string::npos)
+            continue;
+        Memory mem;
+        mem.setSink(&quiet);
+        results.push_back(measure(name, records.size(), options.repeat,
+            [&] { mem.init(HEAP); mem.setAllocator(TYPES[i]); },
+            [&] { runAllocator(mem, records); }));
+    }
+
+    if (std::string("allocator/buddy").find(options.filter) !=
+        std::string::npos) {
+        records = allocatorWorkload(TraceOp::INIT_BUDDY, HEAP);
+        BuddyAllocator buddy;
+        buddy.setSink(&quiet);
+        results.push_back(measure("allocator/buddy", records.size(),
+            options.repeat,
+            [&] { buddy.init(HEAP); },
+            [&] { runAllocator(buddy, records); }));
+    }
+
+    if (std::string("allocator/slab").find(options.filter) !=
+        std::string::npos) {
+        records = allocatorWorkload(TraceOp::INIT_SLAB, HEAP);
+        SlabAllocator slab;
+        slab.setSink(&quiet);
+        results.push_back(measure("allocator/slab", records.size(),
+            options.repeat,
+            [&] { slab.init(HEAP); },
+            [&] { runAllocator(slab, records); }));
+    }
+}
+
+// ---------- Caches ----------
+struct Geometry {
+    const char* name;
+    size_t sets;
+    size_t ways;
+    size_t blockSize;
+};
+
+void benchCaches(const Options& options, std::vector<Result>& results) {
+    // 32 KiB and 1 MiB hit makeCache's compile-time geometries; 96 KiB
+    // with 6 ways and 256 sets is the runtime Cache
+    static const Geometry GEOMETRIES[] = {
+        {"64x8x64", 64, 8, 64},
+        {"1024x16x64", 1024, 16, 64},
+        {"256x6x64", 256, 6, 64},
+    };
+    static const ReplacementPolicy POLICIES[] = {
+        ReplacementPolicy::LRU, ReplacementPolicy::FIFO,
+        ReplacementPolicy::PLRU, ReplacementPolicy::SRRIP,
+        ReplacementPolicy::BRRIP, ReplacementPolicy::RANDOM,
+        ReplacementPolicy::LFU
+    };
+
+    std::vector<TraceRecord> records;
+    std::vector<size_t> addrs;
+
+    for (const Geometry& geometry : GEOMETRIES) {
+        for (ReplacementPolicy policy : POLICIES) {
+            std::string name = std::string("cache/") +
+                               replacementPolicyName(policy) + "/" +
+                               geometry.name;
+            if (name.find(options.filter) == std::string::npos)
+                continue;
+            if (records.empty()) {
+                records = accessWorkload(16 << 20);
+                for (const TraceRecord& record : records)
+                    addrs.push_back(record.arg);
+            }
+
+            std::unique_ptr<CacheModel> cache;
+            results.push_back(measure(name, addrs.size(), options.repeat,
+                [&] {
+                    cache = makeCache(geometry.sets, geometry.ways,
+                                      geometry.blockSize,
+                                      replacementPolicyName(policy),
+                                      "L1", 1);
+                },
+                [&] {
+                    size_t hits = 0;
+                    for (size_t addr : addrs)
+                        hits += cache->access(addr);
+                    checksum = checksum + hits;
+                }));
+        }
+    }
+
+    // the full read / write path: two levels, write-back, NINE
+    std::string name = "cache/hierarchy/l1_l2";
+    if (name.find(options.filter) == std::string::npos)
+        return;
+    if (records.empty())
+        records = accessWorkload(16 << 20);
+
+    CacheHierarchy caches;
+    results.push_back(measure(name, records.size(), options.repeat,
+        [&] {
+            caches.clear();
+            caches.addLevel({"L1", 64, 8, 64, "LRU", 1});
+            caches.addLevel({"L2", 1024, 16, 64, "SRRIP", 1});
+        },
+        [&] {
+            size_t sum = 0;
+            for (const TraceRecord& record : records)
+                sum += caches.access(record.arg,
+                                     record.op == TraceOp::WRITE);
+            checksum = checksum + sum;
+        }));
+}
+
+// Set-partitioned batch replay (CacheModel::accessBatch) on all hardware
+// threads. Before timing it, a four-worker batch is checked against the
+// serial loop: every counter has to match, or the run fails.
+bool benchBatch(const Options& options, std::vector<Result>& results) {
+    std::string name = "cache/batch/LRU/1024x16x64";
+    if (name.find(options.filter) == std::string::npos)
+        return true;
+
+    std::vector<TraceRecord> records = accessWorkload(16 << 20);
+    std::vector<size_t> addrs;
+    std::vector<uint8_t> writes;
+    for (const TraceRecord& record : records) {
+        addrs.push_back(record.arg);
+        writes.push_back(record.op == TraceOp::WRITE);
+    }
+    auto make = [] { return makeCache(1024, 16, 64, "LRU", "L1", 1); };
+
+    std::unique_ptr<CacheModel> serial = make();
+    std::unique_ptr<CacheModel> batched = make();
+    serial->accessBatch(addrs.data(), writes.data(), addrs.size(), 1);
+    batched->accessBatch(addrs.data(), writes.data(), addrs.size(), 4);
+    if (serial->getHits() != batched->getHits() ||
+        serial->getMisses() != batched->getMisses() ||
+        serial->getEvictions() != batched->getEvictions() ||
+        serial->getWritebacks() != batched->getWritebacks()) {
+        std::cout << "Error: " << name << ": batched counters differ from "
+                     "the serial replay\n";
+        return false;
+    }
+
+    std::unique_ptr<CacheModel> cache;
+    results.push_back(measure(name, addrs.size(), options.repeat,
+        [&] { cache = make(); },
+        [&] {
+            cache->accessBatch(addrs.data(), writes.data(), addrs.size());
+            checksum = checksum + cache->getHits();
+        }));
+    return true;
+}
+
+// ---------- Address translation ----------
+struct TranslateCase {
+    const char* name;
+    size_t footprint;           // virtual bytes touched
+    bool tlb;
+    PageReplacement policy;
+};
+
+void benchTranslate(const Options& options, std::vector<Result>& results) {
+    static const size_t PAGE = 4096;
+    static const size_t PHYS = 64 << 20;
+    // fits in memory (walks and TLB hits only), then four times too
+    // large so most misses fault and evict
+    static const TranslateCase CASES[] = {
+        {"vm/translate/resident", 32 << 20, true, PageReplacement::CLOCK},
+        {"vm/translate/no_tlb", 32 << 20, false, PageReplacement::CLOCK},
+        {"vm/translate/evict_clock", 256 << 20, true, PageReplacement::CLOCK},
+        {"vm/translate/evict_lru", 256 << 20, true, PageReplacement::LRU},
+    };
+
+    for (const TranslateCase& c : CASES) {
+        if (std::string(c.name).find(options.filter) == std::string::npos)
+            continue;
+        std::vector<TraceRecord> records = accessWorkload(c.footprint);
+
+        VirtualMemory vm;
+        if (c.tlb) {
+            vm.addTlbLevel({"DTLB", 16, 4, "LRU", 1});
+            vm.addTlbLevel({"STLB", 128, 12, "LRU", 1});
+        }
+        vm.setReplacement(c.policy, 0);
+        results.push_back(measure(c.name, records.size(), options.repeat,
+            [&] { vm.init(PAGE, PHYS); },
+            [&] {
+                size_t sum = 0;
+                TranslateInfo info;
+                for (const TraceRecord& record : records)
+                    sum += vm.translate(record.arg,
+                                        record.op == TraceOp::WRITE, info);
+                checksum = checksum + sum;
+            }));
+    }
+}
+
+// ================= Results =================
+// One result per line, so the baseline can be read back without a JSON
+// library:
+//
+//   {"name":"allocator/tlsf","ops":200000,"ns_per_op":41.2,"ops_per_sec":...}
+bool writeResults(const std::string& path, const Options& options,
+                  const std::vector<Result>& results) {
+    std::ofstream out(path);
+    if (!out) {
+        std::cout << "Error: cannot write " << path << "\n";
+        return false;
+    }
+    out << "{\n  \"repeat\": " << options.repeat << ",\n  \"results\": [\n";
+    for (size_t i = 0; i < results.size(); i++) {
+        const Result& result = results[i];
+        out << "    {\"name\":\"" << result.name << "\",\"ops\":"
+            << result.ops << ",\"ns_per_op\":" << std::fixed
+            << std::setprecision(2) << result.nsPerOp
+            << ",\"ops_per_sec\":" << std::setprecision(0)
+            << 1e9 / result.nsPerOp << "}"
+            << (i + 1 < results.size() ? ",\n" : "\n");
+    }
+    out << "  ]\n}\n";
+    return static_cast<bool>(out);
+}
+
+// name -> ns per op from a results file; false (with a message) if it
+// cannot be read
+bool readBaseline(const std::string& path,
+                  std::map<std::string, double>& baseline) {
+    std::ifstream in(path);
+    if (!in) {
+        std::cout << "Error: cannot open baseline " << path << "\n";
+        return false;
+    }
+    std::string line;
+    while (std::getline(in, line)) {
+        size_t name = line.find("\"name\":\"");
+        size_t ns = line.find("\"ns_per_op\":");
+        if (name == std::string::npos || ns == std::string::npos)
+            continue;
+        name += 8;
+        size_t close = line.find('"', name);
+        if (close == std::string::npos)
+            continue;
+        baseline[line.substr(name, close - name)] =
+            std::strtod(line.c_str() + ns + 12, nullptr);
+    }
+    return true;
+}
+
+// prints the results table, against the baseline if there is one;
+// returns the number of regressions past the threshold
+size_t report(const std::vector<Result>& results,
+              const std::map<std::string, double>& baseline,
+              double threshold) {
+    size_t regressions = 0;
+    std::cout << std::left << std::setw(32) << "Benchmark" << std::right
+              << std::setw(10) << "ops" << std::setw(12) << "ns/op"
+              << std::setw(14) << "ops/s";
+    if (!baseline.empty())
+        std::cout << std::setw(12) << "baseline" << std::setw(10) << "change";
+    std::cout << "\n";
+
+    for (const Result& result : results) {
+        std::cout << std::left << std::setw(32) << result.name << std::right
+                  << std::setw(10) << result.ops << std::fixed
+                  << std::setprecision(2) << std::setw(12) << result.nsPerOp
+                  << std::setprecision(0) << std::setw(14)
+                  << 1e9 / result.nsPerOp;
+        if (!baseline.empty()) {
+            auto it = baseline.find(result.name);
+            if (it == baseline.end() || it->second <= 0) {
+                std::cout << std::setw(12) << "-" << std::setw(10) << "new";
+            } else {
+                double change = (result.nsPerOp / it->second - 1) * 100;
+                std::cout << std::setprecision(2) << std::setw(12)
+                          << it->second << std::showpos
+                          << std::setprecision(1) << std::setw(9) << change
+                          << std::noshowpos << "%";
+                if (change > threshold) {
+                    std::cout << "  REGRESSION";
+                    regressions++;
+                }
+            }
+        }
+        std::cout << "\n";
+    }
+    return regressions;
+}
+
+int main(int argc, char** argv) {
+    // ---------- Command line ----------
+    Options options{"", 7, "", "", 50.0};
+    for (int arg = 1; arg < argc; arg++) {
+        std::string flag = argv[arg];
+        bool ok = arg + 1 < argc;
+        std::string value = ok ? argv[++arg] : "";
+        std::stringstream parse(value);
+
+        if (flag == "--filter")             options.filter = value;
+        else if (flag == "--repeat")        ok = ok && (parse >> options.repeat) && options.repeat > 0;
+        else if (flag == "-o")              options.output = value;
+        else if (flag == "--baseline")      options.baseline = value;
+        else if (flag == "--threshold")     ok = ok && (parse >> options.threshold);
+        else                                ok = false;
+
+        if (!ok) {
+            std::cout << "Usage: memsim-bench [--filter <text>] [--repeat <n>] "
+                         "[-o <results.json>]\n"
+                         "                    [--baseline <baseline.json> "
+                         "[--threshold <percent>]]\n";
+            return 2;
+        }
+    }
+
+    std::map<std::string, double> baseline;
+    if (!options.baseline.empty() && !readBaseline(options.baseline, baseline))
+        return 2;
+
+    // ---------- Run ----------
+    std::vector<Result> results;
+    benchAllocators(options, results);
+    benchCaches(options, results);
+    bool consistent = benchBatch(options, results);
+    benchTranslate(options, results);
+
+    size_t regressions = report(results, baseline, options.threshold);
+    if (!options.output.empty() &&
+        !writeResults(options.output, options, results))
+        return 2;
+    if (!consistent)
+        return 1;
+
+    if (!baseline.empty()) {
+        std::cout << std::defaultfloat << std::setprecision(6);
+        if (regressions > 0) {
+            std::cout << regressions << " benchmark(s) more than "
+                      << options.threshold << "% slower than "
+                      << options.baseline << "\n";
+            return 1;
+        }
+        std::cout << "No regressions past " << options.threshold
+                  << "% against " << options.baseline << "\n";
+    }
+    return 0;
+}
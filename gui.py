@@ -1,27 +1,161 @@
 import sys
+import json
+import queue
+import bisect
 import subprocess
 import threading
 from PySide6.QtWidgets import (
     QApplication, QWidget, QVBoxLayout, QHBoxLayout,
-    QPushButton, QLineEdit, QTextEdit, QLabel, QGroupBox
+    QPushButton, QLineEdit, QPlainTextEdit, QLabel, QGroupBox
 )
-from PySide6.QtCore import QObject, Signal
-from PySide6.QtGui import QFont
+from PySide6.QtCore import QTimer
+from PySide6.QtGui import QFont, QPainter, QColor
 
+# events handled per timer tick, so a flood never blocks the UI
+EVENTS_PER_TICK = 20000
+TICK_MS = 30
 
-# ================= Reader Thread =================
-class Reader(QObject):
-    output = Signal(str)
-    exited = Signal()
 
-    def __init__(self, proc):
-        super().__init__()
+# ================= Reader Thread =================
+# memsim runs with --json: one event per line. The thread only parses;
+# the UI drains the queue on a timer.
+class Reader:
+    def __init__(self, proc, events):
         self.proc = proc
+        self.events = events
 
     def run(self):
         for line in self.proc.stdout:
-            self.output.emit(line.rstrip())
-        self.exited.emit()
+            try:
+                self.events.put(json.loads(line))
+            except ValueError:
+                self.events.put({"event": "text", "text": line.rstrip()})
+        self.events.put({"event": "exit"})
+
+
+# ================= Heap Model =================
+# Mirror of the simulator's heap, kept up to date from split / merge /
+# alloc / free events instead of re-parsing dumps.
+class HeapModel:
+    def __init__(self):
+        self.reset("memory", 0)
+
+    def reset(self, source, size):
+        self.source = source
+        self.size = size
+        self.starts = []        # sorted block addresses
+        self.blocks = {}        # addr -> [size, state, id]
+        self.by_id = {}         # id -> addr
+        if size and source != "slab":
+            self.put(0, size, "free", None)
+
+    def put(self, addr, size, state, block_id):
+        if addr not in self.blocks:
+            bisect.insort(self.starts, addr)
+        self.blocks[addr] = [size, state, block_id]
+
+    def remove_range(self, addr, size):
+        lo = bisect.bisect_left(self.starts, addr)
+        hi = bisect.bisect_left(self.starts, addr + size)
+        for start in self.starts[lo:hi]:
+            del self.blocks[start]
+        del self.starts[lo:hi]
+
+    def apply(self, e):
+        kind = e["event"]
+        if kind == "init":
+            self.reset(e["source"], e["size"])
+        elif kind == "split":
+            self.put(e["addr"], e["size"], "free", None)
+            self.put(e["addr"] + e["size"], e["rest"], "free", None)
+        elif kind == "merge":
+            self.remove_range(e["addr"], e["size"])
+            self.put(e["addr"], e["size"], "free", None)
+        elif kind == "alloc":
+            self.put(e["addr"], e["size"], "used", e["id"])
+            self.by_id[e["id"]] = e["addr"]
+        elif kind == "free":
+            addr = self.by_id.pop(e["id"], None)
+            if addr is None or addr not in self.blocks:
+                return
+            if e["kind"] == "returned":
+                self.remove_range(addr, 1)
+            else:
+                block = self.blocks[addr]
+                block[1] = "lazy" if e["kind"] == "deferred" else "free"
+                block[2] = None
+
+    def used_bytes(self):
+        return sum(b[0] for b in self.blocks.values() if b[1] == "used")
+
+
+# ================= Cache Model =================
+# Lines resident per level, from fill / evict events.
+class CacheModel:
+    def __init__(self):
+        self.lines = {}
+
+    def reset(self):
+        self.lines = {}
+
+    def apply(self, e):
+        level = self.lines.setdefault(e["level"], set())
+        if e["event"] == "fill":
+            level.add(e["addr"])
+        else:
+            level.discard(e["addr"])
+
+    def summary(self):
+        if not self.lines:
+            return "Cache: empty"
+        return "Cache: " + ", ".join(
+            f"{name} {len(lines)} lines" for name, lines in self.lines.items())
+
+
+# ================= Heap View =================
+# One bar over the whole heap. Blocks narrower than a pixel share a
+# column (used wins), so drawing costs O(blocks + width).
+class HeapView(QWidget):
+    COLORS = {
+        "free": QColor("#2e3440"),
+        "lazy": QColor("#b48ead"),
+        "used": QColor("#50fa7b"),
+    }
+    RANK = {None: 0, "free": 1, "lazy": 2, "used": 3}
+
+    def __init__(self, model):
+        super().__init__()
+        self.model = model
+        self.setMinimumHeight(48)
+
+    def paintEvent(self, _):
+        painter = QPainter(self)
+        width, height = self.width(), self.height()
+        painter.fillRect(0, 0, width, height, QColor("#0f111a"))
+        total = self.model.size
+        if not total:
+            return
+
+        columns = [None] * width
+        if self.model.source == "slab":
+            # objects only: the rest of the heap is not modelled
+            columns = ["free"] * width
+        for start in self.model.starts:
+            size, state, _ = self.model.blocks[start]
+            x0 = start * width // total
+            x1 = max(x0 + 1, (start + size) * width // total)
+            for x in range(x0, min(x1, width)):
+                if self.RANK[state] > self.RANK[columns[x]]:
+                    columns[x] = state
+
+        x = 0
+        while x < width:
+            end = x
+            while end < width and columns[end] == columns[x]:
+                end += 1
+            if columns[x]:
+                painter.fillRect(x, 0, end - x, height, self.COLORS[columns[x]])
+            x = end
 
 
 # ================= Main GUI =================
@@ -32,7 +166,7 @@ class MemoryGUI(QWidget):
         self.resize(1100, 750)
 
         self.proc = subprocess.Popen(
-            ["./memsim"],
+            ["./memsim", "--json"],
             stdin=subprocess.PIPE,
             stdout=subprocess.PIPE,
             stderr=subprocess.STDOUT,
@@ -41,7 +175,11 @@ class MemoryGUI(QWidget):
         )
 
         self.alive = True
-        self.mode = "memory"   # memory | buddy
+        self.mode = "memory"   # memory | buddy | slab
+
+        self.events = queue.Queue()
+        self.heap = HeapModel()
+        self.caches = CacheModel()
 
         self.init_ui()
         self.start_reader()
@@ -59,12 +197,25 @@ class MemoryGUI(QWidget):
         self.mode_label.setStyleSheet("color:#8be9fd; font-weight:bold;")
         main.addWidget(self.mode_label)
 
+        # ---------- Heap ----------
+        self.heap_view = HeapView(self.heap)
+        main.addWidget(self.heap_view)
+
+        self.heap_label = QLabel()
+        self.cache_label = QLabel()
+        status = QHBoxLayout()
+        status.addWidget(self.heap_label)
+        status.addWidget(self.cache_label)
+        main.addLayout(status)
+
         # ---------- Console ----------
-        self.console = QTextEdit()
+        # bounded, so long runs do not grow it without limit
+        self.console = QPlainTextEdit()
         self.console.setReadOnly(True)
+        self.console.setMaximumBlockCount(5000)
         self.console.setFont(QFont("Courier New", 10))
         self.console.setStyleSheet("""
-            QTextEdit {
+            QPlainTextEdit {
                 background-color: #0f111a;
                 color: #dcdcdc;
                 border: 1px solid #444;
@@ -77,7 +228,7 @@ class MemoryGUI(QWidget):
         alloc_box = QGroupBox("Allocation Strategy (Memory mode only)")
         alloc_layout = QHBoxLayout()
 
-        for name in ["first_fit", "best_fit", "worst_fit"]:
+        for name in ["first_fit", "best_fit", "worst_fit", "tlsf"]:
             btn = QPushButton(name.replace("_", " ").title())
             btn.clicked.connect(lambda _, n=name: self.set_allocator(n))
             alloc_layout.addWidget(btn)
@@ -96,6 +247,7 @@ class MemoryGUI(QWidget):
         init_row.addWidget(self.init_input)
         init_row.addWidget(self.button("Init Memory", self.init_memory))
         init_row.addWidget(self.button("Init Buddy", self.init_buddy))
+        init_row.addWidget(self.button("Init Slab", self.init_slab))
         cmd_layout.addLayout(init_row)
 
         # Malloc
@@ -118,7 +270,7 @@ class MemoryGUI(QWidget):
         misc = QHBoxLayout()
         misc.addWidget(self.button("Dump Memory", self.dump))
         misc.addWidget(self.button("Memory / Buddy Stats", self.stats))
-        misc.addWidget(self.button("Cache Stats (L1 + L2)", self.cache))
+        misc.addWidget(self.button("Cache Stats", self.cache))
         misc.addWidget(self.button("Exit", self.exit))
         cmd_layout.addLayout(misc)
 
@@ -139,21 +291,85 @@ class MemoryGUI(QWidget):
 
     # ================= Process IO =================
     def start_reader(self):
-        self.reader = Reader(self.proc)
-        self.reader.output.connect(self.handle_output)
-        self.reader.exited.connect(self.on_exit)
+        self.reader = Reader(self.proc, self.events)
         threading.Thread(target=self.reader.run, daemon=True).start()
 
+        self.timer = QTimer(self)
+        self.timer.timeout.connect(self.drain)
+        self.timer.start(TICK_MS)
+
     def on_exit(self):
         self.alive = False
-        self.console.append("[Simulator exited]")
+        self.timer.stop()
+        self.styled("[Simulator exited]")
 
     def styled(self, text, color="#dcdcdc"):
-        self.console.append(f"<span style='color:{color};'>{text}</span>")
+        self.console.appendHtml(f"<span style='color:{color};'>{text}</span>")
 
     # ================= Output =================
-    def handle_output(self, line):
-        self.styled(line)
+    def drain(self):
+        lines = []
+        changed = False
+        for _ in range(EVENTS_PER_TICK):
+            try:
+                e = self.events.get_nowait()
+            except queue.Empty:
+                break
+            kind = e["event"]
+            if kind == "exit":
+                self.flush_lines(lines)
+                self.on_exit()
+                return
+            if kind in ("fill", "evict"):
+                self.caches.apply(e)
+                changed = True
+                continue
+            if kind == "init":
+                self.caches.reset()
+            if kind in ("init", "split", "merge", "alloc", "free"):
+                self.heap.apply(e)
+                changed = True
+            line = self.describe(e)
+            if line is not None:
+                lines.append(line)
+
+        self.flush_lines(lines)
+        if changed:
+            self.heap_view.update()
+            self.heap_label.setText(
+                f"Heap: {len(self.heap.blocks)} blocks, "
+                f"{self.heap.used_bytes()} / {self.heap.size} bytes used")
+            self.cache_label.setText(self.caches.summary())
+
+    def flush_lines(self, lines):
+        if lines:
+            self.console.appendPlainText("\n".join(lines))
+
+    # console line for an event; None for layout-only events
+    def describe(self, e):
+        kind = e["event"]
+        if kind == "text":
+            return e["text"]
+        if kind == "init":
+            return f"{e['source'].title()} initialized: {e['size']} bytes"
+        if kind == "allocator_set":
+            return "Allocator set"
+        if kind == "alloc":
+            return (f"Allocated block id={e['id']} at "
+                    f"address={hex(e['addr'])} size={e['size']}")
+        if kind == "alloc_failed":
+            return "Allocation failed"
+        if kind == "free":
+            return f"Block {e['id']} freed ({e['kind']})"
+        if kind == "invalid_free":
+            return "Invalid block id"
+        if kind == "access":
+            where = e["level"] + " hit" if e.get("level") else "memory"
+            if e.get("outside"):
+                where = "outside the virtual address space"
+            op = "Write" if e["write"] else "Read"
+            return f"{op} {hex(e['addr'])}: {where}"
+        return None
 
     # ================= Commands =================
     def send(self, cmd):
@@ -169,7 +385,7 @@ class MemoryGUI(QWidget):
     # ---------- Mode ----------
     def set_allocator(self, name):
         if self.mode != "memory":
-            self.styled("Allocator ignored in Buddy mode", "#ffb86c")
+            self.styled("Allocator ignored in Buddy/Slab mode", "#ffb86c")
             return
         self.send(f"set allocator {name}")
 
@@ -189,6 +405,14 @@ class MemoryGUI(QWidget):
             self.send(f"init buddy {s}")
             self.init_input.clear()
 
+    def init_slab(self):
+        s = self.init_input.text().strip()
+        if s:
+            self.mode = "slab"
+            self.mode_label.setText("Mode: Slab Allocator")
+            self.send(f"init slab {s}")
+            self.init_input.clear()
+
     # ---------- Actions ----------
     def malloc(self):
         s = self.malloc_input.text().strip()
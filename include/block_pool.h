@@ -0,0 +1,41 @@
+#ifndef BLOCK_POOL_H
+#define BLOCK_POOL_H
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+struct Block;
+
+// Arena of Block nodes owned by Memory.
+// Nodes are carved from fixed-size chunks; released nodes go on a free list
+// threaded through Block::next and are handed out again before any new
+// chunk is touched. reset() returns every node at once without freeing the
+// chunks, so re-initialising memory never goes back to the system allocator.
+class BlockPool {
+public:
+    BlockPool();
+
+    Block* acquire();
+    void release(Block* block);
+
+    // reclaim every node in bulk (used by Memory::init)
+    void reset();
+
+    size_t inUse() const;
+    size_t highWaterMark() const;   // peak nodes in use since last reset
+
+private:
+    static const size_t CHUNK_BLOCKS = 1024;
+
+    std::vector<std::unique_ptr<Block[]>> chunks;
+    size_t chunkIndex;   // chunk currently being carved
+    size_t chunkUsed;    // nodes carved from that chunk
+
+    Block* freeList;
+
+    size_t live;
+    size_t peak;
+};
+
+#endif
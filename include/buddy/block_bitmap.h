@@ -0,0 +1,49 @@
+#ifndef BLOCK_BITMAP_H
+#define BLOCK_BITMAP_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+// Hierarchical bitmap used by the buddy allocator: one bit per block of a
+// given order.
+//
+// Level 0 holds the actual bits. Each summary level above it has one bit
+// per non-zero word of the level below, up to a single top word, so the
+// first set bit is found with one ctz per level (six levels cover 2^36
+// bits). Level-0 words are stored in pages that are only allocated once a
+// bit inside them is set, so a 2^30-block order costs only its summaries
+// until it is actually split that far.
+class BlockBitmap {
+public:
+    static const size_t npos = static_cast<size_t>(-1);
+
+    BlockBitmap();
+
+    void reset(size_t bits);
+
+    void set(size_t bit);
+    void clear(size_t bit);
+    bool test(size_t bit) const;
+
+    bool empty() const;
+    size_t findFirst() const;
+    size_t findNext(size_t bit) const;   // first set bit >= bit
+
+private:
+    static const size_t PAGE_WORDS = 512;   // 32768 bits per leaf page
+
+    size_t bits;
+    size_t leafWords;
+
+    std::vector<std::unique_ptr<uint64_t[]>> pages;
+    std::vector<std::vector<uint64_t>> summary;
+
+    uint64_t leafWord(size_t word) const;
+    uint64_t word(size_t level, size_t index) const;
+    size_t wordCount(size_t level) const;
+    size_t next(size_t level, size_t pos) const;
+};
+
+#endif
@@ -2,15 +2,22 @@
 #define BUDDY_H
 
 #include <cstddef>
-#include <map>
-#include <set>
+#include <cstdint>
+#include <deque>
 #include <vector>
+#include "block_bitmap.h"
+#include "../event_sink.h"
 
 class BuddyAllocator {
 public:
+    // Largest arena main.cpp's init accepts (64 GiB). The page pointers
+    // and summary words of every order's bitmap are allocated up front,
+    // in proportion to the arena: about 300 MB at this size.
+    static const size_t MAX_SIZE = static_cast<size_t>(1) << 36;
+
     struct Block {
         size_t addr;           // starting address
-        int order;             // block order (2^order)
+        int order;             // block order (2^order), -1 if not allocated
         size_t requestedSize;  // original request size
     };
 
@@ -23,33 +30,104 @@ private:
     size_t internalFragmentation;
 
     // allocated blocks indexed by allocation ID
-    std::map<int, Block> allocated;
+    std::vector<Block> allocated;
+
+    // free blocks per order: bit (addr >> order) set when free
+    std::vector<BlockBitmap> freeMaps;
+
+    // bit k set when order k has at least one free block
+    uint64_t nonEmptyOrders;
+
+    // ---------- Lazy coalescing ----------
+    // A freed block parked without merging. pendingMerges is how many
+    // merges eager mode would have done at free time; the avoided counts
+    // are settled against it when the block leaves the list.
+    struct LazyBlock {
+        size_t addr;
+        int pendingMerges;
+    };
+
+    // max parked blocks per order, 0 = eager coalescing
+    size_t lazyWatermark;
 
-    // free lists per order
-    std::vector<std::set<size_t>> freeLists;
+    // parked blocks per order, oldest first
+    std::vector<std::deque<LazyBlock>> lazyLists;
+    size_t lazyCount;
+
+    size_t splits;
+    size_t merges;
+    size_t splitsAvoided;
+    size_t mergesAvoided;
 
     // ---------- Helpers ----------
     int sizeToOrder(size_t size) const;
     size_t orderToSize(int order) const;
     size_t buddyOf(size_t addr, int order) const;
 
+    void markFree(size_t addr, int order);
+    void markUsed(size_t addr, int order);
+    bool isFree(size_t addr, int order) const;
+
+    int coalesce(size_t addr, int order);
+    int countMerges(size_t addr, int order) const;
+    void flushLazy();
+    void unpark(const LazyBlock& blk, int order);
+
+    size_t takeBlock(int order);
+    void returnBlock(size_t addr, int order);
+    bool isAllocated(int id) const;
+
+    EventSink* sink;
+
 public:
     BuddyAllocator();
 
     // initialize allocator with power-of-two memory size
     void init(size_t size);
+    // same as init without reporting
+    void reset(size_t size);
 
-    // allocate block, assigns unique ID internally
-    void mallocBlock(size_t size);
+    // allocate block, assigns unique ID internally; returns it (-1 on
+    // failure)
+    int mallocBlock(size_t size);
 
     // free block using allocation ID
     void freeBlock(int id);
 
+    // where init / mallocBlock / freeBlock report to (defaultSink() at
+    // first)
+    void setSink(EventSink* eventSink);
+
+    // same as mallocBlock / freeBlock without reporting, for layers built
+    // on top of the buddy system (returns -1 / false on failure)
+    size_t allocate(size_t size, int& id);
+    bool release(int id);
+
+    // raw blocks of 2^order units with no id bookkeeping, for callers
+    // that track their own blocks (the VM frame allocator); the caller
+    // must hand back exactly the address and order it got
+    size_t allocateOrder(int order);
+    void releaseOrder(size_t addr, int order);
+    int getMaxOrder() const;
+
+    // free blocks of exactly 2^order units, parked ones included; how
+    // free memory is split across orders is what large requests see
+    size_t freeBlocks(int order) const;
+
+    // lazy-buddy mode: park up to `watermark` freed blocks per order
+    // (0 restores eager coalescing and merges everything parked)
+    void setLazy(size_t watermark);
+
     // dump free lists
     void dump() const;
 
     // ---------- Stats ----------
+    void stats() const;
     size_t getInternalFragmentation() const;
+    size_t getSplits() const;
+    size_t getMerges() const;
+    size_t getSplitsAvoided() const;
+    size_t getMergesAvoided() const;
 };
 
 #endif
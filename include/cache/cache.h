@@ -3,67 +3,219 @@
 
 #include <vector>
 #include <string>
+#include <memory>
 #include <cstddef>
+#include <cstdint>
 #include <iostream>
+#include "geometry.h"
+#include "replacement.h"
+#include "prefetcher.h"
 
-// ================= Cache Line =================
-struct CacheLine {
-    bool valid;
-    size_t tag;
-    size_t age;   // timestamp for LRU / FIFO
+// line pushed out of a cache by fill()
+struct CacheVictim {
+    size_t addr;    // first byte of the line
+    bool dirty;
+};
+
+// ================= Counters =================
+// per-cache event counts; accessBatch gives every worker its own copy
+// (one cache line each, so they never share) and sums them at the end
+struct alignas(64) CacheCounters {
+    size_t accesses;
+    size_t hits;
+    size_t misses;
+    size_t evictions;
+    size_t writebacks;          // dirty lines evicted
+    size_t prefetchFills;
+    size_t prefetchUseful;      // demand hit a prefetched line
+    size_t prefetchLate;        // demand missed a line still in flight
+    size_t prefetchPolluting;   // demand missed a line a prefetch evicted
+    size_t prefetchUnused;      // prefetched line left without being used
+
+    void clear();
+    CacheCounters& operator+=(const CacheCounters& other);
+};
+
+// ================= Cache Interface =================
+// Common interface so callers can hold any geometry specialisation
+// (see makeCache).
+class CacheModel {
+public:
+    virtual ~CacheModel() = default;
+
+    // returns true on HIT, false on MISS (a miss fills the line)
+    virtual bool access(size_t addr) = 0;
+
+    // same result as a lookup (and, on a miss, a fill) of each address
+    // in order, as a write where writes[i] is set (nullptr: all reads).
+    // Sets never interact, so the batch is split by set index into one
+    // substream per worker and replayed on up to `threads` threads (0:
+    // one per hardware thread). Falls back to a serial loop with a
+    // prefetcher attached, since its training order spans sets.
+    virtual void accessBatch(const size_t* addrs, const uint8_t* writes,
+                             size_t count, size_t threads = 0) = 0;
+
+    // ---------- Hierarchy primitives (see CacheHierarchy) ----------
+    // demand lookup: counts the access; a hit updates replacement state
+    // and, for a write, marks the line dirty. A miss does not fill.
+    virtual bool lookup(size_t addr, bool write) = 0;
+
+    // installs the line holding addr; returns true if a valid line was
+    // evicted to make room, described by `victim`. A prefetch fill is
+    // tracked for the useful / polluting / unused prefetch counters.
+    virtual bool fill(size_t addr, bool dirty, CacheVictim& victim,
+                      bool prefetch = false) = 0;
+
+    // presence check with no side effects
+    virtual bool probe(size_t addr) const = 0;
+
+    // drops the line if present; returns true if it was, with its dirty bit
+    virtual bool invalidate(size_t addr, bool& wasDirty) = 0;
+
+    // marks a present line dirty (absorbs a write-back); false if absent
+    virtual bool markDirty(size_t addr) = 0;
+
+    // ---------- Prefetching (see prefetcher.h) ----------
+    // the cache trains its prefetcher on demand misses and first hits to
+    // prefetched lines; the hierarchy collects the requests after each
+    // lookup and delivers them
+    virtual void setPrefetcher(std::unique_ptr<Prefetcher> prefetcher) = 0;
+    virtual const Prefetcher* getPrefetcher() const = 0;
+    virtual const std::vector<size_t>& prefetchRequests() const = 0;
+    // a demand miss found its line still in flight to this level
+    virtual void notePrefetchLate() = 0;
+
+    virtual void reset() = 0;
+    virtual void stats() const = 0;
+
+    virtual size_t getAccesses() const = 0;
+    virtual size_t getHits() const = 0;
+    virtual size_t getMisses() const = 0;
+    virtual size_t getEvictions() const = 0;
+    virtual size_t getWritebacks() const = 0;
+    virtual size_t getPrefetchFills() const = 0;
+    virtual size_t getPrefetchUseful() const = 0;
+    virtual size_t getPrefetchLate() const = 0;
+    virtual size_t getPrefetchPolluting() const = 0;
+
+    virtual size_t getSets() const = 0;
+    virtual size_t getWays() const = 0;
+    virtual size_t getBlockSize() const = 0;
+    virtual ReplacementPolicy getPolicy() const = 0;
+    virtual const std::string& getName() const = 0;
 };
 
 // ================= Cache =================
-class Cache {
+// Set-associative cache parameterised on its geometry (geometry.h).
+// Member definitions live in cache.cpp, which instantiates the runtime
+// geometry and every FixedGeometry used by makeCache.
+template <typename Geometry>
+class BasicCache : public CacheModel {
     // ---------- Identity ----------
     std::string name;
 
     // ---------- Configuration ----------
-    size_t numSets;
-    size_t associativity;
-    size_t blockSize;
-    std::string policy;   // "LRU" or "FIFO"
+    Geometry geometry;
 
     // ---------- Storage ----------
-    std::vector<std::vector<CacheLine>> sets;
+    // Structure of arrays, set-major: line (set, way) lives at index
+    // set * associativity + way in each buffer, so a whole set's tags are
+    // contiguous and can be compared with vector instructions.
+    std::vector<size_t> tags;
+    std::vector<uint8_t> valid;
+    std::vector<uint8_t> dirty;
+    std::vector<uint8_t> prefetched;   // filled by a prefetch, not yet used
+    std::vector<size_t> displaced;     // tag + 1 a prefetch evicted, or 0
 
-    // ---------- Global timer ----------
-    size_t timer;
+    // ---------- Replacement ----------
+    // policy decoded once from its name; unknown names behave as FIFO
+    ReplacementState replacement;
 
     // ---------- Statistics ----------
-    size_t accesses;
-    size_t hits;
-    size_t misses;
-    size_t evictions;
+    CacheCounters counters;
+
+    // ---------- Prefetching ----------
+    std::unique_ptr<Prefetcher> prefetcher;
+    std::vector<size_t> requests;      // from the last lookup
 
     // ---------- Helpers ----------
-    size_t getSetIndex(size_t addr) const;
-    size_t getTag(size_t addr) const;
-    int selectVictim(size_t setIndex);
+    int findWay(size_t base, size_t tag) const;
+
+    // lookup() / fill() against explicit counters, so batch workers can
+    // count privately; a true `train` means the prefetcher wants addr
+    bool lookupLine(size_t addr, bool write, CacheCounters& tally,
+                    bool& train);
+    bool fillLine(size_t addr, bool dirty, CacheVictim& victim,
+                  bool prefetch, CacheCounters& tally);
+    void replaySlice(const size_t* addrs, const uint8_t* writes, size_t n,
+                     CacheCounters& tally);
 
 public:
     // ---------- Constructor ----------
-    Cache(size_t numSets,
-          size_t associativity,
-          size_t blockSize,
-          const std::string& policy,
-          const std::string& name = "");
+    BasicCache(size_t numSets,
+               size_t associativity,
+               size_t blockSize,
+               const std::string& policy,
+               const std::string& name = "",
+               uint64_t seed = 1);
 
     // ---------- Core operation ----------
     // returns true on HIT, false on MISS
-    bool access(size_t addr);
+    bool access(size_t addr) override;
+    void accessBatch(const size_t* addrs, const uint8_t* writes,
+                     size_t count, size_t threads = 0) override;
+
+    // ---------- Hierarchy primitives ----------
+    bool lookup(size_t addr, bool write) override;
+    bool fill(size_t addr, bool dirty, CacheVictim& victim,
+              bool prefetch = false) override;
+    bool probe(size_t addr) const override;
+    bool invalidate(size_t addr, bool& wasDirty) override;
+    bool markDirty(size_t addr) override;
+
+    // ---------- Prefetching ----------
+    void setPrefetcher(std::unique_ptr<Prefetcher> prefetcher) override;
+    const Prefetcher* getPrefetcher() const override;
+    const std::vector<size_t>& prefetchRequests() const override;
+    void notePrefetchLate() override;
 
     // ---------- Control ----------
-    void reset();
+    void reset() override;
 
     // ---------- Reporting ----------
-    void stats() const;
+    void stats() const override;
 
     // ---------- Getters (for hierarchy / GUI / grading) ----------
-    size_t getAccesses() const;
-    size_t getHits() const;
-    size_t getMisses() const;
-    size_t getEvictions() const;
+    size_t getAccesses() const override;
+    size_t getHits() const override;
+    size_t getMisses() const override;
+    size_t getEvictions() const override;
+    size_t getWritebacks() const override;
+    size_t getPrefetchFills() const override;
+    size_t getPrefetchUseful() const override;
+    size_t getPrefetchLate() const override;
+    size_t getPrefetchPolluting() const override;
+
+    size_t getSets() const override;
+    size_t getWays() const override;
+    size_t getBlockSize() const override;
+    ReplacementPolicy getPolicy() const override;
+    const std::string& getName() const override;
 };
 
+// runtime-configured cache, accepts any geometry
+using Cache = BasicCache<DynamicGeometry>;
+
+// ================= Factory =================
+// Returns a compile-time specialised cache when the configuration matches
+// one of the pre-instantiated power-of-two geometries, otherwise a runtime
+// Cache. Both behave identically; the specialisations just index with
+// shifts and unroll the way loops.
+std::unique_ptr<CacheModel> makeCache(size_t numSets,
+                                      size_t associativity,
+                                      size_t blockSize,
+                                      const std::string& policy,
+                                      const std::string& name = "",
+                                      uint64_t seed = 1);
+
 #endif
@@ -0,0 +1,84 @@
+#ifndef CACHE_GEOMETRY_H
+#define CACHE_GEOMETRY_H
+
+#include <cstddef>
+
+// ================= Cache Geometry =================
+// How an address maps onto (set, tag) for BasicCache.
+//
+// DynamicGeometry takes sets / ways / block size at runtime and indexes
+// with division and modulo, so it accepts any configuration.
+// FixedGeometry bakes a power-of-two configuration into the type: indexing
+// becomes shift-and-mask and the way count is a compile-time constant, so
+// loops over a set unroll completely.
+
+struct DynamicGeometry {
+    static constexpr bool FIXED = false;
+
+    size_t numSets;
+    size_t associativity;
+    size_t blockSize;
+
+    DynamicGeometry(size_t numSets, size_t associativity, size_t blockSize)
+        : numSets(numSets),
+          associativity(associativity),
+          blockSize(blockSize) {}
+
+    size_t sets() const { return numSets; }
+    size_t ways() const { return associativity; }
+    size_t block() const { return blockSize; }
+
+    size_t setIndex(size_t addr) const {
+        return (addr / blockSize) % numSets;
+    }
+
+    size_t tag(size_t addr) const {
+        return (addr / blockSize) / numSets;
+    }
+
+    // first byte of the line holding (set, tag)
+    size_t lineAddress(size_t set, size_t tag) const {
+        return (tag * numSets + set) * blockSize;
+    }
+};
+
+constexpr bool isPow2(size_t x) {
+    return x && !(x & (x - 1));
+}
+
+constexpr size_t log2Of(size_t x) {
+    return x <= 1 ? 0 : 1 + log2Of(x >> 1);
+}
+
+template <size_t Sets, size_t Ways, size_t BlockSize>
+struct FixedGeometry {
+    static_assert(isPow2(Sets), "set count must be a power of two");
+    static_assert(isPow2(BlockSize), "block size must be a power of two");
+    static_assert(Ways >= 1 && Ways <= 64, "1..64 ways supported");
+
+    static constexpr bool FIXED = true;
+    static constexpr size_t WAYS = Ways;
+    static constexpr size_t BLOCK_SHIFT = log2Of(BlockSize);
+    static constexpr size_t SET_SHIFT = log2Of(Sets);
+
+    // runtime arguments are accepted for a uniform constructor and ignored
+    FixedGeometry(size_t, size_t, size_t) {}
+
+    static constexpr size_t sets() { return Sets; }
+    static constexpr size_t ways() { return Ways; }
+    static constexpr size_t block() { return BlockSize; }
+
+    static size_t setIndex(size_t addr) {
+        return (addr >> BLOCK_SHIFT) & (Sets - 1);
+    }
+
+    static size_t tag(size_t addr) {
+        return addr >> (BLOCK_SHIFT + SET_SHIFT);
+    }
+
+    static size_t lineAddress(size_t set, size_t tag) {
+        return ((tag << SET_SHIFT) | set) << BLOCK_SHIFT;
+    }
+};
+
+#endif
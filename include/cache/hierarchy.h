@@ -0,0 +1,169 @@
+#ifndef CACHE_HIERARCHY_H
+#define CACHE_HIERARCHY_H
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <string>
+#include <vector>
+#include "cache.h"
+#include "../event_sink.h"
+#include "stack_distance.h"
+
+// ================= Inclusion Policy =================
+enum class InclusionPolicy {
+    INCLUSIVE,   // every line in level i is also in level i + 1
+    EXCLUSIVE,   // a line lives in at most one level
+    NINE         // non-inclusive, non-exclusive: no enforcement
+};
+
+// "inclusive" / "exclusive" / "nine" (case-insensitive); false if unknown
+bool parseInclusionPolicy(const std::string& text, InclusionPolicy& out);
+const char* inclusionPolicyName(InclusionPolicy policy);
+
+// ================= Level Configuration =================
+struct CacheLevelConfig {
+    std::string name;
+    size_t sets;
+    size_t ways;
+    size_t blockSize;
+    std::string policy;
+    uint64_t seed;
+};
+
+// ================= Prefetch Configuration =================
+struct PrefetchConfig {
+    PrefetcherType type;
+    size_t degree;
+    bool toNext;     // fill the level below instead of the trained one
+};
+
+// ================= Cache Hierarchy =================
+// Ordered cache levels, level 0 closest to the CPU, backed by memory.
+// Writes are write-back / write-allocate: a write miss fetches the line
+// like a read and installs it dirty in level 0; dirty lines only travel
+// down when evicted.
+//
+//   * NINE      : a miss fills every level above the one that hit.
+//   * INCLUSIVE : as NINE, and evicting a line from level i also
+//                 invalidates it in levels 0..i-1 (back-invalidation);
+//                 their dirty data leaves with it.
+//   * EXCLUSIVE : a miss fills level 0 only; a hit in a lower level moves
+//                 the line up to level 0. Every line evicted from level i
+//                 (clean or dirty) is inserted into level i + 1.
+//
+// Prefetches requested by a level's prefetcher are put in flight and
+// installed `prefetchLatency` requests later, into that level or the one
+// below it. A demand miss on a line still in flight counts as a late
+// prefetch and the demand fetch takes over.
+class CacheHierarchy {
+    static const size_t MAX_IN_FLIGHT = 64;
+
+    struct InFlight {
+        size_t addr;
+        size_t level;
+        uint64_t ready;    // request count at which it lands
+    };
+
+    std::vector<std::unique_ptr<CacheModel>> levels;
+    std::vector<PrefetchConfig> prefetch;   // per level
+    InclusionPolicy inclusion;
+
+    // ---------- Prefetch queue ----------
+    std::deque<InFlight> inFlight;          // in issue order
+    size_t prefetchLatency;
+
+    // ---------- Statistics ----------
+    size_t reads;
+    size_t writes;
+    size_t memoryReads;         // lines fetched from memory
+    size_t memoryWrites;        // dirty lines written to memory
+    size_t backInvalidations;   // upper-level lines dropped for inclusion
+    size_t prefetchReads;       // prefetched lines fetched from memory
+
+    // ---------- Profiling ----------
+    // optional stack-distance profile of the request stream, at the
+    // first level's block size (see stack_distance.h)
+    bool profiling;
+    StackDistanceProfiler profile;
+
+    // receives line fills and evictions when set
+    EventSink* sink;
+
+    // ---------- Helpers ----------
+    void install(size_t level, size_t addr, bool dirty,
+                 bool prefetched = false);
+    void spill(size_t level, const CacheVictim& victim);
+    void attachPrefetcher(size_t level);
+    void issuePrefetches(size_t level);
+    void completePrefetches();
+    void installPrefetch(size_t level, size_t addr);
+    bool cancelInFlight(size_t level, size_t addr);
+
+public:
+    // ---------- Constructor ----------
+    CacheHierarchy();
+
+    // ---------- Configuration ----------
+    // appends a level below the current last one; false (with a message)
+    // if the geometry is unusable
+    bool addLevel(const CacheLevelConfig& config);
+    void clear();
+
+    // text file, one directive per line ('#' starts a comment):
+    //   level <name> <sets> <ways> <blockSize> <policy> [seed]
+    //   inclusion <inclusive|exclusive|nine>
+    //   prefetch <level> <none|next_line|stride|stream> [degree] [same|next]
+    //   prefetch_latency <requests>
+    // replaces the current levels only if the whole file parses
+    bool loadConfig(const std::string& path);
+
+    void setInclusion(InclusionPolicy policy);
+    InclusionPolicy getInclusion() const;
+
+    // rebuilds one level, empty, with a new replacement policy
+    bool setPolicy(size_t level, const std::string& policy, uint64_t seed);
+
+    // attaches (or with NONE removes) a level's prefetcher
+    bool setPrefetcher(size_t level, const PrefetchConfig& config);
+    void setPrefetchLatency(size_t requests);
+    size_t getPrefetchLatency() const;
+
+    // starts (from empty) or stops recording the stack-distance profile
+    void setProfiling(bool enabled);
+    bool isProfiling() const;
+    const StackDistanceProfiler& getProfile() const;
+
+    // reports every line filled or evicted (nullptr: none, the default)
+    void setSink(EventSink* eventSink);
+
+    // ---------- Core operation ----------
+    // index of the level that hit, or -1 if the line came from memory
+    int access(size_t addr, bool write = false);
+
+    // access() on each address in order, as a write where isWrite[i] is
+    // set (nullptr: all reads). A single level with no prefetcher, profiling or sink is just
+    // one cache, so the batch goes to its accessBatch (on up to `threads`
+    // threads, 0: one per hardware thread); anything else runs serially.
+    void accessBatch(const size_t* addrs, const uint8_t* isWrite,
+                     size_t count, size_t threads = 0);
+
+    // ---------- Control ----------
+    void reset();
+
+    // ---------- Reporting ----------
+    void stats() const;
+
+    // ---------- Getters ----------
+    size_t numLevels() const;
+    const CacheModel& level(size_t index) const;
+    // level index from "l2" / "L2" or a level name; -1 if none
+    int findLevel(const std::string& text) const;
+
+    size_t getRequests() const;
+    size_t getMemoryReads() const;
+    size_t getMemoryWrites() const;
+};
+
+#endif
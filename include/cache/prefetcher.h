@@ -0,0 +1,119 @@
+#ifndef PREFETCHER_H
+#define PREFETCHER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+// ================= Prefetcher Type =================
+enum class PrefetcherType {
+    NONE,
+    NEXT_LINE,   // the `degree` lines after each miss
+    STRIDE,      // constant stride between misses in a region
+    STREAM       // ascending streams, kept `degree` lines ahead
+};
+
+// "none" / "next_line" / "stride" / "stream" (case-insensitive)
+bool parsePrefetcherType(const std::string& text, PrefetcherType& out);
+const char* prefetcherTypeName(PrefetcherType type);
+
+// ================= Prefetcher =================
+// Hardware prefetcher model attached to a cache. The cache trains it on
+// every demand miss, and on the first demand hit to a line the prefetcher
+// brought in (otherwise a working prefetcher would starve itself of
+// misses). Training returns the line addresses worth fetching; the
+// hierarchy decides where they go and when they arrive.
+class Prefetcher {
+public:
+    virtual ~Prefetcher() = default;
+
+    // appends the first byte of every line to prefetch to `out`
+    virtual void train(size_t addr, std::vector<size_t>& out) = 0;
+    virtual void reset() = 0;
+
+    virtual PrefetcherType getType() const = 0;
+    size_t getDegree() const { return degree; }
+
+protected:
+    Prefetcher(size_t blockSize, size_t degree)
+        : blockSize(blockSize), degree(degree ? degree : 1) {}
+
+    size_t blockSize;
+    size_t degree;
+};
+
+// ================= Next-Line =================
+class NextLinePrefetcher : public Prefetcher {
+public:
+    NextLinePrefetcher(size_t blockSize, size_t degree);
+
+    void train(size_t addr, std::vector<size_t>& out) override;
+    void reset() override;
+    PrefetcherType getType() const override;
+};
+
+// ================= Stride =================
+// PC-less stride detector: misses are grouped by 4 KiB region, and each
+// region remembers its last line and stride. Once the same non-zero
+// stride is seen twice in a row, `degree` strides ahead are prefetched.
+class StridePrefetcher : public Prefetcher {
+public:
+    StridePrefetcher(size_t blockSize, size_t degree);
+
+    void train(size_t addr, std::vector<size_t>& out) override;
+    void reset() override;
+    PrefetcherType getType() const override;
+
+private:
+    static const size_t ENTRIES = 16;
+    static const size_t REGION_SHIFT = 12;
+
+    struct Entry {
+        bool valid;
+        size_t region;
+        size_t lastLine;
+        long long stride;
+        int confidence;
+        uint64_t lastUse;
+    };
+
+    std::vector<Entry> table;
+    uint64_t clock;
+};
+
+// ================= Stream =================
+// Stream buffer directory: a miss that falls inside a tracked stream
+// (just past its last demand line, up to where it has fetched) advances
+// it and tops it up to `degree` lines ahead; any other miss starts a new
+// stream in the least recently used slot. Only ascending streams.
+class StreamPrefetcher : public Prefetcher {
+public:
+    StreamPrefetcher(size_t blockSize, size_t degree);
+
+    void train(size_t addr, std::vector<size_t>& out) override;
+    void reset() override;
+    PrefetcherType getType() const override;
+
+private:
+    static const size_t STREAMS = 8;
+
+    struct Stream {
+        bool valid;
+        size_t lastLine;    // last demand line seen
+        size_t nextLine;    // next line not yet prefetched
+        uint64_t lastUse;
+    };
+
+    std::vector<Stream> streams;
+    uint64_t clock;
+};
+
+// ================= Factory =================
+// nullptr for PrefetcherType::NONE
+std::unique_ptr<Prefetcher> makePrefetcher(PrefetcherType type,
+                                           size_t blockSize,
+                                           size_t degree);
+
+#endif
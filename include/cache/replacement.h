@@ -0,0 +1,93 @@
+#ifndef REPLACEMENT_H
+#define REPLACEMENT_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// ================= Replacement Policy =================
+enum class ReplacementPolicy {
+    LRU,      // least recently used
+    FIFO,     // oldest fill
+    PLRU,     // tree pseudo-LRU
+    SRRIP,    // static re-reference interval prediction
+    BRRIP,    // bimodal RRIP (scan resistant)
+    RANDOM,   // seeded per-set random
+    LFU       // least frequently used
+};
+
+// "lru", "SRRIP", ... (case-insensitive); false if unknown
+bool parseReplacementPolicy(const std::string& text, ReplacementPolicy& out);
+const char* replacementPolicyName(ReplacementPolicy policy);
+
+// ================= Replacement State =================
+// Per-set bookkeeping for one replacement policy. The cache reports hits
+// and fills, and asks for a victim only when every way of the set is
+// valid. All state is per set, so independent sets never interact.
+//
+// No policy scans the set to pick a victim:
+//   * LRU / FIFO : intrusive recency list per set, victim = tail
+//   * PLRU       : (ways - 1) tree bits per set, victim = walk the tree
+//   * SRRIP/BRRIP: one way-bitmask per 2-bit RRPV value, victim = ctz of
+//                  the RRPV=3 mask (aging shifts the masks, at most 3x)
+//   * LFU        : one way-bitmask per 4-bit saturating count plus a
+//                  non-empty summary, victim = ctz of the lowest count
+//   * RANDOM     : xorshift per set
+// The mask-based policies (PLRU, SRRIP, BRRIP, LFU) handle up to 64 ways;
+// wider sets fall back to LRU.
+class ReplacementState {
+public:
+    ReplacementState(ReplacementPolicy policy,
+                     size_t numSets,
+                     size_t ways,
+                     uint64_t seed = 1);
+
+    void reset();
+
+    void onHit(size_t set, size_t way);
+    void onFill(size_t set, size_t way);
+
+    // way to evict from a full set
+    size_t victim(size_t set);
+
+    ReplacementPolicy getPolicy() const;
+
+private:
+    static const uint16_t NONE = 0xFFFF;
+    static const int RRPV_MAX = 3;
+    static const int LFU_MAX = 15;
+    static const unsigned BRRIP_THROTTLE = 32;   // 1 in 32 fills "long"
+
+    ReplacementPolicy policy;
+    size_t numSets;
+    size_t ways;
+    uint64_t seed;
+
+    // ---------- LRU / FIFO ----------
+    std::vector<uint16_t> prevWay;     // per line
+    std::vector<uint16_t> nextWay;
+    std::vector<uint16_t> head;        // per set, most recent
+    std::vector<uint16_t> tail;        // per set, victim
+
+    // ---------- PLRU ----------
+    std::vector<uint64_t> treeBits;    // per set, node i at bit i
+    size_t leaves;                     // ways rounded up to a power of two
+
+    // ---------- RRIP / LFU ----------
+    std::vector<uint8_t> level;        // per line: RRPV or use count
+    std::vector<uint64_t> levelMasks;  // per set, one mask per level
+    std::vector<uint16_t> nonEmpty;    // per set, LFU levels in use
+    std::vector<uint32_t> fills;       // per set, BRRIP throttle counter
+
+    // ---------- RANDOM ----------
+    std::vector<uint64_t> rng;         // per set
+
+    size_t levels() const;
+    void moveToFront(size_t set, size_t way);
+    void setLevel(size_t set, size_t way, int value);
+    void touchTree(size_t set, size_t way);
+    size_t treeVictim(size_t set) const;
+};
+
+#endif
@@ -0,0 +1,105 @@
+#ifndef STACK_DISTANCE_H
+#define STACK_DISTANCE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// ================= Reuse Stack =================
+// LRU stack distance of one address stream (Mattson). Every access stamps
+// its line with the next slot number and a Fenwick tree marks the slot
+// holding each line's latest access. The distance of a re-access is the
+// number of marked slots after the line's previous one, i.e. the distinct
+// lines touched in between: O(log n) per access. Slots are renumbered
+// once the tree fills up, so memory stays proportional to distinct lines.
+//
+// The caller stores each line's slot (so one hash lookup can serve many
+// stacks); the stack keeps a pointer back to it for renumbering, which is
+// why slot variables must not move while the stack is in use.
+class ReuseStack {
+public:
+    static const size_t COLD = static_cast<size_t>(-1);
+    static const uint32_t NONE = UINT32_MAX;   // line not in this stack
+
+    ReuseStack();
+
+    void reset();
+
+    // distance since this line's previous access, or COLD on first touch;
+    // `slot` is the line's slot (NONE initially) and is updated
+    size_t touch(uint32_t& slot);
+
+    size_t distinct() const;
+
+private:
+    std::vector<uint32_t*> owner;                // slot -> line's slot var
+    std::vector<uint32_t> tree;                  // Fenwick, 1-based
+    size_t live;
+
+    void add(size_t slot, int delta);
+    size_t prefix(size_t slot) const;            // marks in [0, slot]
+    void rebuild(size_t capacity);
+};
+
+// ================= Stack Distance Profiler =================
+// Single-pass hit-rate curves for LRU caches of every size.
+//
+// An access hits in a fully associative LRU cache of C lines iff its
+// stack distance is < C. A set-associative LRU cache with S sets and W
+// ways is S independent stacks, one per set, so it hits iff the distance
+// inside the line's set is < W. The profiler keeps one ReuseStack for the
+// whole stream and one per set for every power-of-two set count up to
+// MAX_SETS, and histograms the distances. Every (sets, ways) curve is
+// then read off the histograms without replaying the trace.
+class StackDistanceProfiler {
+public:
+    static const size_t MAX_SETS = 1024;
+    static const size_t MAX_WAYS = 64;
+
+    StackDistanceProfiler();
+
+    void reset(size_t blockSize);
+    void access(size_t addr);
+
+    // hits an LRU cache with `sets` sets (a power of two <= MAX_SETS,
+    // or 1) and `ways` ways would have had on the recorded stream
+    uint64_t hits(size_t sets, size_t ways) const;
+
+    uint64_t getAccesses() const;
+    uint64_t getColdMisses() const;
+    size_t getDistinctLines() const;
+    size_t getBlockSize() const;
+
+    // ---------- Reporting ----------
+    void printCurve() const;
+    // one row per (sets, ways): sets,ways,lines,bytes,hits,hit_rate
+    bool writeCsv(const std::string& path) const;
+
+private:
+    static const size_t SET_COUNTS = 10;   // 2, 4, ..., MAX_SETS
+
+    struct SetCount {
+        size_t sets;
+        std::vector<ReuseStack> stacks;   // one per set
+        std::vector<uint64_t> histogram;  // distance -> count, < MAX_WAYS
+    };
+
+    // a line's slot in the full stack and in its set's stack per count
+    struct LineSlots {
+        uint32_t full;
+        uint32_t bySets[SET_COUNTS];
+    };
+
+    size_t blockSize;
+    uint64_t accesses;
+    uint64_t coldMisses;
+
+    std::unordered_map<size_t, LineSlots> lines;
+    ReuseStack full;
+    std::vector<uint64_t> fullHistogram;  // unbounded distances
+    std::vector<SetCount> setCounts;      // sets = 2, 4, ..., MAX_SETS
+};
+
+#endif
@@ -0,0 +1,223 @@
+#ifndef EVENT_SINK_H
+#define EVENT_SINK_H
+
+#include <cstddef>
+#include <ostream>
+#include <sstream>
+#include <string>
+
+// ================= Events =================
+// What the allocators and the read / write path report per operation.
+// They call the sink instead of formatting text themselves, so a batch
+// run can buffer the text, count the events or drop them.
+
+// which allocator an event comes from
+enum class EventSource {
+    MEMORY,
+    BUDDY,
+    SLAB
+};
+
+// how a block went back to its allocator
+enum class FreeKind {
+    MERGED,         // coalesced with free neighbours (Memory, Buddy)
+    DEFERRED,       // parked by lazy buddy coalescing
+    RETURNED        // slab object back in its slab
+};
+
+// one read / write through the VM and the caches
+struct AccessEvent {
+    size_t addr;
+    bool write;
+    bool translated;            // VM on: phys and fault are set
+    bool outside;               // outside the virtual address space
+    size_t phys;
+    bool fault;
+    int level;                  // cache level that hit, or -1 (memory)
+    const char* levelName;      // name of that level
+};
+
+class EventSink {
+public:
+    virtual ~EventSink() {}
+
+    // `slabSize` only for SLAB
+    virtual void initialized(EventSource source, size_t bytes,
+                             size_t slabSize) = 0;
+    virtual void allocatorSet() = 0;
+
+    // `size` is the block size handed out (the request for MEMORY)
+    virtual void allocated(EventSource source, int id, size_t addr,
+                           size_t size) = 0;
+    virtual void allocationFailed(EventSource source, size_t size) = 0;
+    virtual void freed(EventSource source, int id, FreeKind kind) = 0;
+    virtual void invalidFree(EventSource source, int id) = 0;
+
+    virtual void accessed(const AccessEvent& event) = 0;
+
+    // ---------- Layout changes ----------
+    // Ignored unless a sink wants them. Memory and Buddy report how the
+    // heap changes shape; a CacheHierarchy given this sink reports lines.
+
+    // the free block at addr became [addr, addr + size) and the free
+    // block [addr + size, addr + size + rest)
+    virtual void split(EventSource, size_t /*addr*/, size_t /*size*/,
+                       size_t /*rest*/) {}
+    // [addr, addr + size) is now one free block
+    virtual void merged(EventSource, size_t /*addr*/, size_t /*size*/) {}
+    // `addr` is the first byte of the line
+    virtual void cacheFilled(const std::string& /*level*/, size_t /*addr*/,
+                             bool /*prefetched*/) {}
+    virtual void cacheEvicted(const std::string& /*level*/, size_t /*addr*/,
+                              bool /*dirty*/) {}
+
+    // writes out anything buffered; callers flush before printing
+    // directly to the same stream
+    virtual void flush() {}
+};
+
+// the sink every allocator starts with: unbuffered text on std::cout
+EventSink& defaultSink();
+
+// ================= Sinks =================
+// Drops every event.
+class NullSink : public EventSink {
+public:
+    void initialized(EventSource, size_t, size_t) override {}
+    void allocatorSet() override {}
+    void allocated(EventSource, int, size_t, size_t) override {}
+    void allocationFailed(EventSource, size_t) override {}
+    void freed(EventSource, int, FreeKind) override {}
+    void invalidFree(EventSource, int) override {}
+    void accessed(const AccessEvent&) override {}
+};
+
+// The interactive text, byte for byte. Lines are formatted into a
+// buffer without stream manipulators and written out once it holds
+// `flushBytes` (0: after every event).
+class TextSink : public EventSink {
+public:
+    static const size_t BATCH_BYTES = 1 << 16;
+
+    TextSink(std::ostream& out, size_t flushBytes);
+    ~TextSink();
+
+    void initialized(EventSource source, size_t bytes,
+                     size_t slabSize) override;
+    void allocatorSet() override;
+    void allocated(EventSource source, int id, size_t addr,
+                   size_t size) override;
+    void allocationFailed(EventSource source, size_t size) override;
+    void freed(EventSource source, int id, FreeKind kind) override;
+    void invalidFree(EventSource source, int id) override;
+    void accessed(const AccessEvent& event) override;
+    void flush() override;
+
+private:
+    std::ostream& out;
+    size_t flushBytes;
+    std::string buffer;
+
+    void put(const char* text);
+    void putDec(size_t value);
+    void putHex(size_t value);
+    void endLine();
+};
+
+// Counts the events and prints nothing until report().
+struct EventCounts {
+    size_t allocations;
+    size_t allocationFailures;
+    size_t frees;
+    size_t invalidFrees;
+    size_t reads;
+    size_t writes;
+    size_t cacheHits;
+    size_t memoryAccesses;      // missed every cache level
+    size_t pageFaults;
+    size_t outside;             // outside the virtual address space
+};
+
+class CountingSink : public EventSink {
+public:
+    CountingSink();
+
+    void initialized(EventSource, size_t, size_t) override {}
+    void allocatorSet() override {}
+    void allocated(EventSource, int, size_t, size_t) override {
+        counts.allocations++;
+    }
+    void allocationFailed(EventSource, size_t) override {
+        counts.allocationFailures++;
+    }
+    void freed(EventSource, int, FreeKind) override {
+        counts.frees++;
+    }
+    void invalidFree(EventSource, int) override {
+        counts.invalidFrees++;
+    }
+    void accessed(const AccessEvent& event) override;
+
+    const EventCounts& getCounts() const;
+    void report(std::ostream& out) const;
+
+private:
+    EventCounts counts;
+};
+
+// One JSON object per line, for programs driving memsim (gui.py):
+//
+//   {"event":"alloc","source":"memory","id":3,"addr":128,"size":64}
+//
+// with every event above, layout changes included, so a client can keep
+// its own copy of the heap and the caches up to date without dumps.
+// The sink takes over `stream` (std::cout) while it lives: whatever else
+// is printed there becomes {"event":"text","text":"..."} lines, in order.
+// ready() stands in for the prompt: the previous command's output is
+// complete and memsim waits for the next one.
+class JsonSink : public EventSink {
+public:
+    explicit JsonSink(std::ostream& stream);
+    ~JsonSink();
+
+    JsonSink(const JsonSink&) = delete;
+    JsonSink& operator=(const JsonSink&) = delete;
+
+    void initialized(EventSource source, size_t bytes,
+                     size_t slabSize) override;
+    void allocatorSet() override;
+    void allocated(EventSource source, int id, size_t addr,
+                   size_t size) override;
+    void allocationFailed(EventSource source, size_t size) override;
+    void freed(EventSource source, int id, FreeKind kind) override;
+    void invalidFree(EventSource source, int id) override;
+    void accessed(const AccessEvent& event) override;
+
+    void split(EventSource source, size_t addr, size_t size,
+               size_t rest) override;
+    void merged(EventSource source, size_t addr, size_t size) override;
+    void cacheFilled(const std::string& level, size_t addr,
+                     bool prefetched) override;
+    void cacheEvicted(const std::string& level, size_t addr,
+                      bool dirty) override;
+
+    void flush() override;
+
+    // {"event":"ready"}, then everything is written out
+    void ready();
+
+private:
+    std::ostream& captured;         // the stream taken over
+    std::streambuf* real;           // where it wrote before
+    std::stringstream text;         // what was printed to it since
+    std::string buffer;
+
+    void begin(const char* event);
+    void field(const char* name, size_t value);
+    void field(const char* name, bool value);
+    void field(const char* name, const char* value);
+    void end();
+    void drainText();
+};
+
+#endif
@@ -0,0 +1,65 @@
+#ifndef FREE_INDEX_H
+#define FREE_INDEX_H
+
+#include <cstddef>
+#include <cstdint>
+#include <set>
+#include <vector>
+
+struct Block;
+
+// Index over the free blocks of Memory, kept next to the address-ordered
+// block list so that every fit policy avoids a full list walk.
+//
+//   * bySize  : free blocks ordered by (size, start)  -> best fit
+//   * treap   : free blocks ordered by start, each node caching the largest
+//               free size in its subtree              -> first / worst fit
+//
+// Only non-empty free blocks are indexed; zero-byte requests are resolved
+// by Memory itself.
+class FreeIndex {
+public:
+    FreeIndex();
+
+    void clear();
+    void insert(Block* block);
+    void erase(Block* block);
+
+    // lowest-address block with size >= request
+    Block* firstFit(size_t size) const;
+    // smallest block with size >= request, lowest address on ties
+    Block* bestFit(size_t size) const;
+    // largest block (if >= request), lowest address on ties
+    Block* worstFit(size_t size) const;
+
+    size_t size() const;
+
+private:
+    struct BySize {
+        bool operator()(const Block* a, const Block* b) const;
+    };
+
+    struct Node {
+        Block* block;
+        int left;
+        int right;
+        uint32_t priority;
+        size_t maxSize;   // largest block size in this subtree
+    };
+
+    std::set<Block*, BySize> bySize;
+
+    // ---------- Address treap ----------
+    std::vector<Node> nodes;
+    std::vector<int> spareNodes;
+    int root;
+    uint32_t seed;
+
+    int newNode(Block* block);
+    uint32_t nextPriority();
+    void pull(int t);
+    void split(int t, size_t start, int& left, int& right);
+    int merge(int left, int right);
+};
+
+#endif
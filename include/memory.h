@@ -2,11 +2,17 @@
 #define MEMORY_H
 
 #include <cstddef>
+#include <vector>
+#include "block_pool.h"
+#include "event_sink.h"
+#include "free_index.h"
+#include "tlsf_index.h"
 
 enum class AllocatorType {
     FIRST_FIT,
     BEST_FIT,
-    WORST_FIT
+    WORST_FIT,
+    TLSF
 };
 
 struct Block {
@@ -15,6 +21,11 @@ struct Block {
     bool free;
     int id;
     Block* next;
+    Block* prev;
+
+    // segregated free-list links (TLSF only)
+    Block* nextFree;
+    Block* prevFree;
 };
 
 class Memory {
@@ -24,21 +35,45 @@ private:
     int nextId;
     AllocatorType allocator;
 
+    // storage for every Block node in the list
+    BlockPool pool;
+
+    // free blocks by size and by address (see free_index.h)
+    FreeIndex freeIndex;
+
+    // free blocks by size class, used instead of freeIndex under TLSF
+    TlsfIndex tlsf;
+
+    // used blocks indexed by allocation ID (nullptr once freed)
+    std::vector<Block*> blocksById;
+
     Block* findBlock(size_t size);
+    Block* scanBlock(size_t size);
     void splitBlock(Block* block, size_t size);
-    void coalesce();
+    Block* coalesce(Block* block);
+
+    void indexInsert(Block* block);
+    void indexErase(Block* block);
+    void rebuildIndex();
 
     int allocSuccess;
     int allocFail;
 
+    EventSink* sink;
+
 public:
     Memory();
 
     void init(size_t size);
     void setAllocator(AllocatorType type);
 
+    // where init / malloc / free report to (defaultSink() at first)
+    void setSink(EventSink* eventSink);
+
     // IMPORTANT: return address for cache access
     size_t mallocBlock(size_t size);
+    // same, also giving the block id (-1 on failure)
+    size_t mallocBlock(size_t size, int& id);
     size_t freeBlock(int id);
 
     void dump();
@@ -0,0 +1,127 @@
+#ifndef MULTICORE_H
+#define MULTICORE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "../cache/cache.h"
+#include "../cache/hierarchy.h"
+
+// ================= Core-Tagged Access =================
+struct CoreAccess {
+    size_t addr;
+    bool write;
+};
+
+// Reads "<core> <r|w> <address>" lines ('#' starts a comment, address in
+// decimal or 0x-hex) into one stream per core. False (with a message) on
+// a malformed line or a core id >= MulticoreSim::MAX_CORES.
+bool loadCoreTrace(const std::string& path,
+                   std::vector<std::vector<CoreAccess>>& streams);
+
+// ================= MESI State =================
+enum class MesiState : uint8_t {
+    INVALID,
+    SHARED,
+    EXCLUSIVE,
+    MODIFIED
+};
+
+// ================= Multicore Simulator =================
+// N private L1 caches over a shared L2, kept coherent with MESI through a
+// full-map directory (sharer bitmask + exclusive owner per line).
+//
+// Replay runs in epochs. In the parallel phase every core's worker thread
+// replays its own stream for up to `epochLength` accesses, as long as
+// they complete inside its L1 without coherence traffic: read hits, and
+// write hits in E or M (E upgrades to M silently). The first access that
+// needs the directory (a miss, or a write to an S line) stalls the core
+// until the serial phase, where the directory serves every stalled core
+// in core order. Workers only touch their own core's state in the
+// parallel phase, so results do not depend on thread timing or count.
+class MulticoreSim {
+public:
+    static const size_t MAX_CORES = 64;
+
+    MulticoreSim(size_t cores,
+                 const CacheLevelConfig& l1,
+                 const CacheLevelConfig& l2,
+                 size_t epochLength,
+                 size_t threads);
+
+    // replays one stream per core; returns wall-clock seconds
+    double run(const std::vector<std::vector<CoreAccess>>& streams);
+
+    void stats() const;
+
+private:
+    // ---------- Per-core state ----------
+    struct LineState {
+        MesiState state;
+        uint64_t words;     // 8-byte words touched since the line arrived
+    };
+
+    struct Pending {
+        bool active;
+        CoreAccess access;
+        bool upgrade;       // write hit on a SHARED line
+    };
+
+    struct Core {
+        std::unique_ptr<CacheModel> l1;
+        std::unordered_map<size_t, LineState> lines;   // line -> state
+        size_t position;     // next access in the stream
+        Pending pending;
+
+        // statistics
+        size_t reads;
+        size_t writes;
+        size_t upgrades;
+        size_t demoted;          // upgrades that became write misses
+        size_t invalidationsReceived;
+        size_t falseSharing;     // invalidations of untouched words
+        size_t writebacks;
+    };
+
+    // ---------- Directory ----------
+    struct DirectoryEntry {
+        uint64_t sharers;    // cores holding the line
+        int owner;           // core in E or M, or -1
+    };
+
+    size_t blockSize;
+    size_t epochLength;
+    size_t threads;
+
+    std::vector<Core> cores;
+    std::unique_ptr<CacheModel> l2;
+    std::unordered_map<size_t, DirectoryEntry> directory;
+    const std::vector<std::vector<CoreAccess>>* streams;
+
+    // ---------- Coherence traffic ----------
+    size_t getS;             // read misses sent to the directory
+    size_t getM;             // write misses (read for ownership)
+    size_t upgradeRequests;  // S -> M
+    size_t invalidations;    // invalidation messages sent
+    size_t interventions;    // owner downgraded M/E -> S for a reader
+    size_t cacheToCache;     // data supplied by another L1
+    size_t putM;             // M lines written back to L2
+    size_t memoryReads;
+    size_t memoryWrites;
+    size_t epochs;
+    double elapsed;
+
+    // ---------- Helpers ----------
+    size_t wordBit(size_t addr) const;
+    void runLocal(size_t core);
+    void serve(size_t core);
+    void fillL1(size_t core, size_t addr, MesiState state);
+    void dropCopy(size_t core, size_t line, size_t writerAddr);
+    void writeBackToL2(size_t addr);
+    void readFromL2(size_t addr);
+};
+
+#endif
@@ -0,0 +1,94 @@
+#ifndef SLAB_H
+#define SLAB_H
+
+#include <cstddef>
+#include <vector>
+#include "../buddy/buddy.h"
+
+// Slab allocator layered on top of BuddyAllocator.
+//
+// Small requests are served from per-size-class caches: each cache carves
+// fixed-size objects out of slabs (one buddy page each), so a request only
+// wastes the gap to its size class instead of the gap to the next power
+// of two, and no buddy split happens until a slab fills up. Requests
+// larger than the biggest class go straight to the buddy allocator.
+class SlabAllocator {
+public:
+    SlabAllocator();
+
+    // initialize backing buddy memory (power of two)
+    void init(size_t size);
+
+    // returns the block id (-1 on failure)
+    int mallocBlock(size_t size);
+    void freeBlock(int id);
+
+    // where init / mallocBlock / freeBlock report to (defaultSink() at
+    // first)
+    void setSink(EventSink* eventSink);
+
+    // slabs by address, then the buddy free lists
+    void dump() const;
+
+    // per-class occupancy and fragmentation compared with plain buddy
+    void stats() const;
+
+    // ---------- Stats ----------
+    // bytes wasted by this allocator (size-class rounding + large blocks)
+    size_t getInternalFragmentation() const;
+    // bytes plain buddy would waste for the same live requests
+    size_t getBuddyFragmentation() const;
+
+private:
+    struct Slab {
+        size_t addr;
+        int pageId;                    // buddy allocation backing the slab
+        int sizeClass;
+        size_t used;
+        std::vector<unsigned> freeObjects;
+        size_t partialPos;             // position in its class' partial list
+    };
+
+    struct SizeClass {
+        size_t objectSize;
+        size_t objectsPerSlab;
+        std::vector<int> partial;      // slabs with at least one free object
+        size_t slabs;
+        size_t liveObjects;
+    };
+
+    struct Object {
+        size_t addr;
+        size_t requestedSize;
+        int sizeClass;                 // -1 = served directly by buddy
+        int owner;                     // slab index, or buddy id if large
+        bool live;
+    };
+
+    static const size_t SLAB_SIZE = 4096;
+    static const size_t NO_PARTIAL = static_cast<size_t>(-1);
+
+    BuddyAllocator buddy;
+    size_t slabSize;
+
+    std::vector<SizeClass> classes;
+    std::vector<int> classBySize;      // (size + 7) / 8 -> class index
+    std::vector<Slab> slabs;
+    std::vector<int> spareSlabs;
+    std::vector<int> slabByPage;       // addr / slabSize -> slab index
+
+    std::vector<Object> objects;       // indexed by allocation ID
+    int nextId;
+
+    size_t slabFragmentation;          // objectSize - requested, live objects
+    size_t buddyEquivalent;            // what plain buddy would have wasted
+
+    EventSink* sink;
+
+    int classFor(size_t size) const;
+    int newSlab(int sizeClass);
+    void removePartial(Slab& slab);
+    static size_t roundPow2(size_t size);
+};
+
+#endif
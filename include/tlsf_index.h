@@ -0,0 +1,42 @@
+#ifndef TLSF_INDEX_H
+#define TLSF_INDEX_H
+
+#include <cstddef>
+#include <cstdint>
+
+struct Block;
+
+// Two-Level Segregated Fit index over the free blocks of Memory.
+//
+// Sizes are split into first-level classes (powers of two) and each of
+// those into SL_COUNT linear second-level classes. Every (fl, sl) class
+// keeps a doubly linked list threaded through Block::nextFree/prevFree,
+// and two bitmaps record which classes are non-empty, so insert, erase
+// and find are all O(1) bit operations.
+//
+// find() rounds the request up to the next class boundary ("good fit"),
+// so any block it returns is large enough without scanning the list.
+class TlsfIndex {
+public:
+    TlsfIndex();
+
+    void clear();
+    void insert(Block* block);
+    void erase(Block* block);
+
+    // a free block with size >= request, or nullptr
+    Block* find(size_t size) const;
+
+private:
+    static const int SL_BITS = 4;
+    static const int SL_COUNT = 1 << SL_BITS;
+    static const int FL_COUNT = 64 - SL_BITS + 1;
+
+    uint64_t flBitmap;
+    uint32_t slBitmap[FL_COUNT];
+    Block* heads[FL_COUNT][SL_COUNT];
+
+    static void mapping(size_t size, int& fl, int& sl);
+};
+
+#endif
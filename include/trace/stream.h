@@ -0,0 +1,141 @@
+#ifndef STREAM_H
+#define STREAM_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <thread>
+
+// ================= SPSC Ring =================
+// Bounded single-producer / single-consumer queue of preallocated slots.
+// The producer fills slot `tail % N` and publishes it by bumping tail;
+// the consumer reads slot `head % N` and hands it back by bumping head.
+// Each side only writes its own index, so no locks are needed, and the
+// indices sit on separate cache lines so the two threads do not share
+// one. Both sides spin (yielding) while the ring is full or empty.
+template <typename T, size_t N>
+class SpscRing {
+public:
+    SpscRing() : slots(new T[N]), head(0), tail(0) {}
+
+    // ---------- Producer ----------
+    // slot to fill next, or nullptr if the ring is full
+    T* claim() {
+        size_t t = tail.value.load(std::memory_order_relaxed);
+        if (t - head.value.load(std::memory_order_acquire) == N)
+            return nullptr;
+        return &slots[t % N];
+    }
+    void publish() {
+        tail.value.fetch_add(1, std::memory_order_release);
+    }
+
+    // ---------- Consumer ----------
+    // oldest published slot, or nullptr if the ring is empty
+    T* front() {
+        size_t h = head.value.load(std::memory_order_relaxed);
+        if (h == tail.value.load(std::memory_order_acquire))
+            return nullptr;
+        return &slots[h % N];
+    }
+    void pop() {
+        head.value.fetch_add(1, std::memory_order_release);
+    }
+
+private:
+    struct alignas(64) Index {
+        std::atomic<size_t> value;
+        explicit Index(size_t v) : value(v) {}
+    };
+
+    std::unique_ptr<T[]> slots;
+    Index head;
+    Index tail;
+};
+
+// ================= Streamed Access Traces =================
+struct TraceAccess {
+    uint64_t addr;
+    bool write;
+};
+
+// what the producer saw; final once next() has returned false
+struct StreamStats {
+    size_t lines;
+    size_t accesses;
+    size_t reads;
+    size_t writes;
+    size_t instructions;        // lackey "I" fetches, not replayed
+    size_t ignored;             // blank, comment and tool banner lines
+    size_t malformed;
+};
+
+// Reads a memory-access trace of any size with constant memory. A
+// producer thread reads the file (through `gzip -dc` / `zstd -dc` for
+// .gz / .zst files), parses it and hands fixed-size batches of accesses
+// to the consumer through an SpscRing, so decompression and parsing
+// overlap with whatever the consumer does with the batches.
+//
+// One line per access, in any of these formats (mixed freely):
+//
+//   Valgrind lackey   " L 04222cac,8"   L load, S store, M modify (a
+//                                        load then a store), I fetch
+//   pinatrace         "0x40068a: W 0x7ffd1c"
+//   memsim            "w 0x7ffd1c"       (paging compare traces)
+//
+// Lines starting with "==" (Valgrind banners) are ignored, and '#'
+// starts a comment.
+class TraceStream {
+public:
+    static const size_t BATCH = 4096;     // accesses per batch
+    static const size_t SLOTS = 8;        // batches in flight
+
+    TraceStream();
+    ~TraceStream();
+
+    TraceStream(const TraceStream&) = delete;
+    TraceStream& operator=(const TraceStream&) = delete;
+
+    // opens the trace and starts the producer; false (with a message) if
+    // the file cannot be opened
+    bool open(const std::string& path);
+
+    // next batch of accesses; false at the end of the trace. The batch
+    // stays valid until the following call.
+    bool next(const TraceAccess*& accesses, size_t& count);
+
+    // waits for the producer; false (with a message) if reading or
+    // decompressing failed. Stops the producer early if the consumer
+    // did not drain the trace.
+    bool finish();
+
+    const StreamStats& getStats() const;
+
+private:
+    struct Batch {
+        size_t count;
+        TraceAccess items[BATCH];
+    };
+
+    SpscRing<Batch, SLOTS> ring;
+    std::thread producer;
+    std::atomic<bool> done;         // producer published its last batch
+    std::atomic<bool> cancel;       // consumer gave up early
+    bool holding;                   // consumer still has the front batch
+
+    std::FILE* file;
+    bool piped;                     // file comes from popen()
+    std::string path;
+    StreamStats stats;
+    bool readError;
+
+    void produce();
+    void parseLine(const char* begin, const char* end, Batch*& batch);
+    Batch* claimBatch();
+    void emit(uint64_t addr, bool write, Batch*& batch);
+};
+
+#endif
@@ -0,0 +1,161 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <climits>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <vector>
+#include "../memory.h"
+
+// ================= Binary Trace Format =================
+// A replayable command stream without text. The file starts with a
+// 16-byte little-endian header:
+//
+//   bytes 0-3   magic "MSTR"
+//   byte  4     version (1)
+//   byte  5     encoding (TraceEncoding)
+//   bytes 6-7   reserved, zero
+//   bytes 8-15  record count
+//
+// followed by the records:
+//
+//   * FIXED : one 64-bit word per record, opcode in the top byte and the
+//             argument in the low 56 bits
+//   * DELTA : one opcode byte, then the zigzag LEB128 varint of the
+//             argument minus the previous argument of the same kind
+//             (reads and writes share one address stream), so runs of
+//             nearby addresses and sequential ids take a byte or two
+enum class TraceOp : uint8_t {
+    INIT_MEMORY = 1,    // arg: size
+    INIT_BUDDY,         // arg: size
+    INIT_SLAB,          // arg: size
+    INIT_VM,            // arg: log2 page size | log2 physical size << 8
+    SET_ALLOCATOR,      // arg: AllocatorType
+    MALLOC,             // arg: size
+    FREE,               // arg: block id
+    READ,               // arg: address
+    WRITE               // arg: address
+};
+
+enum class TraceEncoding : uint8_t {
+    FIXED = 0,
+    DELTA = 1
+};
+
+struct TraceRecord {
+    TraceOp op;
+    uint64_t arg;
+};
+
+const char* traceOpName(TraceOp op);
+
+// ================= Writer =================
+class TraceWriter {
+public:
+    static const uint64_t MAX_ARG = (1ull << 56) - 1;
+
+    TraceWriter();
+    ~TraceWriter();
+
+    // false (with a message) if the file cannot be created
+    bool open(const std::string& path, TraceEncoding encoding);
+
+    // `arg` must be at most MAX_ARG
+    void append(TraceOp op, uint64_t arg);
+
+    // writes the record count into the header; false on an I/O error
+    bool close();
+
+    size_t getRecords() const;
+    size_t getBytes() const;
+
+private:
+    std::ofstream out;
+    TraceEncoding encoding;
+    std::vector<uint8_t> buffer;       // flushed in large writes
+    uint64_t previous[16];             // last argument per stream (DELTA)
+    size_t records;
+    size_t bytes;
+
+    void flush();
+};
+
+// ================= Reader =================
+// Maps the whole file read-only and decodes records in place, so replay
+// does no parsing and no copying beyond the record being decoded.
+class TraceReader {
+public:
+    TraceReader();
+    ~TraceReader();
+
+    TraceReader(const TraceReader&) = delete;
+    TraceReader& operator=(const TraceReader&) = delete;
+
+    // false (with a message) if the file is missing or not a trace
+    bool open(const std::string& path);
+
+    // next record; false at the end or on a truncated record
+    bool next(TraceRecord& record) {
+        if (cursor == end)
+            return false;
+        if (encoding == TraceEncoding::FIXED) {
+            if (end - cursor < 8)
+                return corrupt();
+            uint64_t word;
+            std::memcpy(&word, cursor, 8);
+            cursor += 8;
+            record.op = static_cast<TraceOp>(word >> 56);
+            record.arg = word & ((1ull << 56) - 1);
+            if (record.op < TraceOp::INIT_MEMORY ||
+                record.op > TraceOp::WRITE || !validArg(record.op, record.arg))
+                return corrupt();
+            return true;
+        }
+        return nextDelta(record);
+    }
+
+    // a record was cut short, had an unknown opcode, or an argument its
+    // command cannot take
+    bool isCorrupt() const;
+    uint64_t getRecords() const;        // count from the header
+    TraceEncoding getEncoding() const;
+
+private:
+    const uint8_t* base;
+    size_t length;
+    const uint8_t* cursor;
+    const uint8_t* end;
+    TraceEncoding encoding;
+    uint64_t records;
+    uint64_t previous[16];
+    bool corrupted;
+
+    // FREE names an int block id and SET_ALLOCATOR an AllocatorType;
+    // anything larger is corruption, not a value to cast through
+    static bool validArg(TraceOp op, uint64_t arg) {
+        if (op == TraceOp::FREE)
+            return arg <= INT_MAX;
+        if (op == TraceOp::SET_ALLOCATOR)
+            return arg <= static_cast<uint64_t>(AllocatorType::TLSF);
+        return true;
+    }
+
+    bool nextDelta(TraceRecord& record);
+    bool corrupt();
+    void unmap();
+};
+
+// ================= Script Conversion =================
+// Converts a command script (the tests/*.txt format) into a binary trace.
+// init, set allocator, malloc, free, read and write become records; every
+// other command (stats, dump, cache and VM configuration, ...) has no
+// record and is skipped, as is (with a message) a malformed line of a
+// convertible command. False (with a message) on an I/O error.
+bool convertScript(const std::string& scriptPath,
+                   const std::string& tracePath,
+                   TraceEncoding encoding);
+
+#endif
@@ -0,0 +1,126 @@
+#ifndef PAGE_TABLE_H
+#define PAGE_TABLE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+// ================= Page Table =================
+// Radix tree over a 48-bit virtual address space, 9 index bits per level
+// like x86-64: 4 levels for 4 KiB pages, fewer for larger pages (the top
+// level takes whatever bits are left). Nodes are allocated on demand, so
+// a sparse address space only pays for the paths it uses, and a node is
+// recycled once its last entry is unmapped.
+//
+// Nodes live in a pool of fixed-size chunks (like BlockPool) and refer to
+// their children by pool index: growing the pool never moves a node, and
+// a million-page table is never copied to grow.
+//
+// An interior entry with HUGE set is itself a leaf (x86's PS bit): one
+// entry one level above the leaves maps 2^9 pages (2 MiB at 4 KiB pages),
+// two levels above 2^18 (1 GiB). Page orders below count base pages, so
+// they are 0, 9 or 18.
+class PageTable {
+public:
+    static const size_t VA_BITS = 48;
+    static const size_t LEVEL_BITS = 9;
+    static const size_t FANOUT = 1 << LEVEL_BITS;
+
+    // ---------- Entries ----------
+    // x86-64 style: flags in the low bits, frame (or, in interior nodes,
+    // child node) number from bit FRAME_SHIFT up
+    static const uint64_t PRESENT  = 1ull << 0;
+    static const uint64_t ACCESSED = 1ull << 1;
+    static const uint64_t DIRTY    = 1ull << 2;
+    static const uint64_t HUGE     = 1ull << 7;
+    static const size_t FRAME_SHIFT = 12;
+
+    static uint64_t makeEntry(size_t frame, uint64_t flags) {
+        return (static_cast<uint64_t>(frame) << FRAME_SHIFT) | flags;
+    }
+    static size_t entryFrame(uint64_t entry) {
+        return static_cast<size_t>(entry >> FRAME_SHIFT);
+    }
+
+    PageTable();
+
+    // empty table for pages of 2^pageShift bytes
+    void reset(size_t pageShift);
+
+    // leaf entry of `vpn`, or nullptr if no path to it exists (the entry
+    // itself may still be non-present)
+    uint64_t* find(size_t vpn);
+    // same, adding the entries a hardware walk would read to `reads`
+    uint64_t* find(size_t vpn, size_t& reads);
+    // same, stopping at a huge leaf; `order` is the order of the page the
+    // returned entry maps
+    uint64_t* find(size_t vpn, size_t& reads, size_t& order);
+
+    // leaf entry of `vpn`, creating missing interior nodes; `vpn` must not
+    // lie under a huge mapping
+    uint64_t& map(size_t vpn);
+
+    // huge leaf of order 9 or 18 covering `vpn`, creating missing interior
+    // nodes; the region must hold no mappings (unmap them first)
+    uint64_t& mapHuge(size_t vpn, size_t order);
+
+    // clears the leaf (base or huge) mapping `vpn` and frees nodes left
+    // empty
+    void unmap(size_t vpn);
+
+    // turns the huge leaf mapping `vpn` into a node of 512 leaves of the
+    // next order down (same frames and flags); that node's entries, or
+    // nullptr if `vpn` is not under a huge leaf
+    uint64_t* split(size_t vpn);
+
+    // ---------- Regions ----------
+    struct Mapping {
+        size_t vpn;                     // first page
+        uint64_t entry;
+        size_t order;
+    };
+
+    // every mapping inside the aligned region of 2^order pages holding
+    // `vpn`, in address order (a single entry if a huge leaf covers it)
+    void collect(size_t vpn, size_t order, std::vector<Mapping>& out);
+
+    // present entries in the node below the region's slot: 0 when nothing
+    // in the region is mapped, FANOUT when a huge leaf covers it or (for
+    // order 9) every page is mapped
+    size_t populated(size_t vpn, size_t order);
+
+    // a huge leaf of `order` fits in this table
+    bool supportsOrder(size_t order) const;
+
+    size_t getLevels() const;
+    size_t getNodes() const;            // live nodes, root included
+    size_t getMappedPages() const;      // in base pages
+
+private:
+    static const size_t CHUNK_NODES = 64;
+
+    struct Node {
+        uint64_t entries[FANOUT];
+        uint32_t live;                  // present entries
+    };
+
+    size_t levels;
+    size_t topBits;                     // index bits of the root level
+    std::vector<std::unique_ptr<Node[]>> chunks;
+    size_t poolSize;                    // nodes carved from the chunks
+    std::vector<uint32_t> freeNodes;
+    size_t liveNodes;
+    size_t mappedPages;
+
+    size_t indexAt(size_t vpn, size_t level) const;
+    size_t levelOrder(size_t level) const;   // order a leaf there maps
+    void collectNode(uint32_t index, size_t level, size_t base,
+                     std::vector<Mapping>& out);
+    Node& node(uint32_t index) {
+        return chunks[index / CHUNK_NODES][index % CHUNK_NODES];
+    }
+    uint32_t newNode();
+};
+
+#endif
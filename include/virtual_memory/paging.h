@@ -0,0 +1,55 @@
+#ifndef PAGING_H
+#define PAGING_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// ================= Page Replacement Policy =================
+enum class PageReplacement {
+    FIFO,       // oldest mapping
+    LRU,        // least recently translated (exact, O(1) list)
+    CLOCK,      // second chance on the PTE accessed bit
+    WSCLOCK     // Clock plus working-set age and dirty-page cleaning
+};
+
+// "fifo" / "lru" / "clock" / "wsclock" (case-insensitive)
+bool parsePageReplacement(const std::string& text, PageReplacement& out);
+const char* pageReplacementName(PageReplacement policy);
+
+// ================= Page Reference Trace =================
+struct PageRef {
+    size_t addr;
+    bool write;
+};
+
+// Reads "<r|w> <address>" lines ('#' starts a comment, address in
+// decimal or 0x-hex). False (with a message) on a malformed line.
+bool loadPageTrace(const std::string& path, std::vector<PageRef>& refs);
+
+// ================= Offline Optimal (Belady) =================
+struct OptResult {
+    size_t faults;
+    size_t evictions;
+    size_t dirtyEvictions;
+};
+
+// Replays `refs` with `frames` frames, evicting the resident page whose
+// next use is furthest away. The next use of every reference is
+// precomputed in one backward pass, and resident pages are ordered by
+// it, so each reference costs O(log frames).
+OptResult simulateOpt(const std::vector<PageRef>& refs,
+                      size_t pageSize,
+                      size_t frames);
+
+// ================= Policy Comparison =================
+// Replays `refs` once per policy (FIFO, LRU, CLOCK, WSCLOCK with
+// working-set window `tau`) on a fresh VirtualMemory without TLBs, and
+// once through OPT, and prints their fault counts side by side.
+void comparePaging(const std::vector<PageRef>& refs,
+                   size_t pageSize,
+                   size_t physSize,
+                   size_t tau);
+
+#endif
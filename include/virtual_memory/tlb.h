@@ -0,0 +1,93 @@
+#ifndef TLB_H
+#define TLB_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "../cache/replacement.h"
+
+// ================= TLB Configuration =================
+struct TlbConfig {
+    std::string name;
+    size_t sets;
+    size_t ways;
+    std::string policy;     // any ReplacementPolicy name
+    uint64_t seed;
+};
+
+// ================= TLB =================
+// One set-associative TLB level caching page -> frame translations.
+// Entries are tagged with the address-space id (ASID) that owns them, so
+// switching address spaces needs no flush. Sets are indexed by virtual
+// page number and share the cache's ReplacementState machinery.
+//
+// Entries may map huge pages: an entry of order k (2^k base pages) is
+// tagged and indexed by vpn >> k and holds the first frame of the page,
+// so one entry covers the whole huge page. A lookup probes every order
+// it is asked about, like a unified STLB.
+class Tlb {
+public:
+    static const uint16_t MAX_ASID = 4095;   // 12-bit, like x86 PCIDs
+
+    explicit Tlb(const TlbConfig& config);
+
+    // frame of (asid, vpn) if cached; a hit updates replacement state.
+    // `dirty` is the entry's cached dirty bit.
+    bool lookup(uint16_t asid, size_t vpn, size_t& frame, bool& dirty);
+    // same, probing each page order whose bit is set in `orders`; `frame`
+    // is the first frame of the page and `order` its order
+    bool lookup(uint16_t asid, size_t vpn, uint32_t orders,
+                size_t& frame, bool& dirty, size_t& order);
+
+    // caches a translation (after a page walk or from a lower level);
+    // for a huge page `vpn` is any page inside it and `frame` its first
+    void insert(uint16_t asid, size_t vpn, size_t frame, bool dirty,
+                size_t order = 0);
+
+    // drops one translation (page evicted or remapped); false if absent
+    bool invalidate(uint16_t asid, size_t vpn, size_t order = 0);
+
+    // drops every translation, or those of one address space
+    void flush();
+    void flushAsid(uint16_t asid);
+
+    // empties the TLB and clears its counters
+    void reset();
+
+    // `pageSize` for the reach lines
+    void stats(size_t pageSize) const;
+
+    // bytes the valid entries map right now (huge entries count in full)
+    size_t getCurrentReach(size_t pageSize) const;
+
+    const std::string& getName() const;
+    size_t getEntries() const;
+    size_t getAccesses() const;
+    size_t getHits() const;
+    size_t getMisses() const;
+
+private:
+    TlbConfig config;
+
+    // ---------- Storage (set-major, like BasicCache) ----------
+    std::vector<size_t> vpns;       // tags: vpn >> order, order on top
+    std::vector<uint16_t> asids;
+    std::vector<size_t> frames;
+    std::vector<uint8_t> valid;
+    std::vector<uint8_t> dirty;
+
+    ReplacementState replacement;
+
+    // ---------- Statistics ----------
+    size_t accesses;
+    size_t hits;
+    size_t misses;
+    size_t evictions;
+    size_t flushes;             // full or per-ASID flushes
+    size_t hugeHits;            // hits on entries of order > 0
+
+    int findWay(size_t base, uint16_t asid, size_t tag) const;
+};
+
+#endif
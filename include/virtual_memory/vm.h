@@ -2,24 +2,215 @@
 #define VM_H
 
 #include <cstddef>
+#include <cstdint>
+#include <string>
 #include <unordered_map>
-#include <queue>
+#include <vector>
+#include "page_table.h"
+#include "paging.h"
+#include "tlb.h"
+#include "../buddy/buddy.h"
 
+// ================= Huge Pages =================
+enum class HugePageMode {
+    OFF,        // base pages only (huge pages only through promote())
+    FAULT,      // map a huge page at fault when a free block allows it
+    PROMOTE     // collapse a region once every base page in it is mapped
+};
+
+// "off" / "fault" / "promote"
+bool parseHugePageMode(const std::string& text, HugePageMode& out);
+const char* hugePageModeName(HugePageMode mode);
+
+// how translate() found the frame
+struct TranslateInfo {
+    int tlbLevel;       // TLB level that hit, or -1 (page walk)
+    bool fault;         // the page was not mapped
+};
+
+// ================= Virtual Memory =================
+// Demand paging over a 48-bit virtual address space. Every address space
+// (ASID) has its own radix page table (page_table.h); physical frames are
+// shared and come from a BuddyAllocator counting in frames, so every
+// frame handed out is free and a freed frame goes straight back to the
+// pool. When no frame is left, the replacement policy picks a victim:
+//
+//   * FIFO / LRU : one intrusive list over frames, newest first; LRU
+//                  also moves a frame to the front on every translation
+//   * CLOCK      : a hand sweeps the frames, clearing accessed bits,
+//                  and evicts the first frame found with A clear
+//   * WSCLOCK    : as CLOCK, but an unreferenced page only goes if it
+//                  is older than the window `tau` (in translations);
+//                  old dirty pages are cleaned (written back) and
+//                  skipped, and after two sweeps the first unreferenced
+//                  page found goes anyway
+//
+// Clearing a PTE's accessed or dirty bit also drops the page from the
+// TLBs, so the next reference walks the table and sets the bit again.
+//
+// Huge pages (orders 9 and 18: 2 MiB and 1 GiB at 4 KiB pages) take a
+// naturally aligned block of 2^order frames from the buddy allocator.
+// The block is one unit for replacement: only its first frame is on the
+// FIFO / LRU list or seen by the clock hand, and evicting it frees the
+// whole block. Promotion copies a region's base pages into a fresh block
+// and maps it with one huge leaf; demotion splits a huge leaf into 512
+// mappings one order down that keep their frames. When a block has to
+// be evicted for, the whole aligned region around the policy's victim
+// goes, since single victims rarely free a contiguous block. The cost is
+// the one real kernels pay: a huge page needs a free block of its order,
+// which a fragmented frame pool may not have.
+//
+// Translations go through the configured TLB levels first (level 0
+// closest to the CPU). A hit in level i refills levels 0..i-1 and skips
+// the page table; a miss everywhere walks the table and fills every
+// level. Evicting a page shoots its translation down from every level.
 class VirtualMemory {
+public:
+    static const size_t INVALID = static_cast<size_t>(-1);
+
+    // Most frames init accepts (64 GiB of 4 KiB pages). The per-frame
+    // replacement state is allocated up front, about 40 bytes a frame,
+    // and frame numbers must stay below NO_FRAME.
+    static const size_t MAX_FRAMES = static_cast<size_t>(1) << 24;
+
+    VirtualMemory();
+
+    // page size and physical memory must be powers of two, with at least
+    // one frame and at most MAX_FRAMES; false (with a message)
+    // otherwise. TLB levels are kept but emptied.
+    bool init(size_t pageSize, size_t physSize);
+    bool isInitialized() const;
+
+    // physical address of vAddr in the current address space, mapping
+    // its page on a fault; INVALID for an address outside the virtual
+    // address space
+    size_t translate(size_t vAddr, bool write, TranslateInfo& info);
+    size_t translate(size_t vAddr);
+
+    // ---------- Address spaces ----------
+    // switches to (and creates) address space `asid` <= Tlb::MAX_ASID;
+    // TLB entries are ASID-tagged, so nothing is flushed
+    bool setAsid(size_t asid);
+    uint16_t getAsid() const;
+
+    // ---------- Replacement ----------
+    // applies from the next eviction; `tau` only matters to WSCLOCK
+    void setReplacement(PageReplacement policy, size_t tau);
+    PageReplacement getReplacement() const;
+    size_t getTau() const;
+
+    // ---------- Huge pages ----------
+    void setHugePages(HugePageMode mode);
+    HugePageMode getHugePages() const;
+
+    // maps the aligned region of `bytes` (page size << 9 or << 18) holding
+    // vAddr in the current address space with one huge page, copying the
+    // base pages already mapped there; may evict to find a free block.
+    // False (with a message) if the size is not a huge-page size here or
+    // a page at least as large already covers the region.
+    bool promote(size_t vAddr, size_t bytes);
+
+    // splits the huge page holding vAddr into 512 pages one order down;
+    // false (with a message) if vAddr is not on a huge page
+    bool demote(size_t vAddr);
+
+    // ---------- TLB ----------
+    void addTlbLevel(const TlbConfig& config);
+    void clearTlb();
+    void flushTlb();                 // every entry
+    void flushTlb(uint16_t asid);    // one address space
+    size_t numTlbLevels() const;
+    const Tlb& tlbLevel(size_t i) const;
+
+    void stats() const;
+
+    size_t getPageSize() const;
+    size_t getPhysSize() const;
+    size_t getTranslations() const;
+    size_t getHits() const;
+    size_t getPageFaults() const;
+    size_t getEvictions() const;
+    size_t getDirtyEvictions() const;
+    size_t getCleanings() const;
+    size_t getWalks() const;
+    size_t getWalkReads() const;
+    const PageTable& getPageTable() const;
+
+private:
+    struct MappedPage {
+        uint16_t asid;
+        uint8_t order;               // 0, 9 or 18
+        size_t vpn;                  // first page
+    };
+
+    static const size_t HUGE_ORDERS = 2;     // orders 9 and 18
+
     size_t pageSize;
+    size_t pageShift;
     size_t numFrames;
 
-    std::unordered_map<size_t, size_t> pageTable;
-    std::queue<size_t> fifo;
+    // ---------- Address spaces ----------
+    // unordered_map never moves its values, so `table` stays valid
+    std::unordered_map<uint16_t, PageTable> tables;
+    uint16_t asid;
+    PageTable* table;                // current address space
+
+    BuddyAllocator frames;           // one unit per frame
+    size_t usedFrames;
+
+    // ---------- Replacement (indexed by frame) ----------
+    static const uint32_t NO_FRAME = UINT32_MAX;
 
+    PageReplacement replacement;
+    size_t tau;
+
+    std::vector<MappedPage> owner;      // page mapped in each frame
+    std::vector<uint64_t*> pte;         // its leaf entry (nodes never move);
+                                        // null on free and tail frames
+    std::vector<uint32_t> prevFrame;    // FIFO / LRU list, newest first
+    std::vector<uint32_t> nextFrame;
+    uint32_t newest;
+    uint32_t oldest;
+    size_t hand;                        // CLOCK / WSCLOCK
+    std::vector<uint64_t> lastUse;      // WSCLOCK: last time A was seen
+
+    std::vector<Tlb> tlbs;
+
+    HugePageMode hugeMode;
+    size_t hugeMapped[HUGE_ORDERS];  // huge pages mapped now, per order
+
+    // ---------- Statistics ----------
+    size_t translations;
+    size_t hits;                     // page was mapped (TLB hit or walk)
     size_t pageFaults;
-    size_t hits;
+    size_t evictions;
+    size_t dirtyEvictions;           // written back to backing store
+    size_t cleanings;                // WSCLOCK write-backs before eviction
+    size_t walks;                    // page-table walks (TLB misses)
+    size_t walkReads;                // page-table entries read by walks
+    size_t dirtyAssists;             // walks to set D under a clean entry
+    size_t shootdowns;               // TLB entries invalidated by eviction
+    size_t hugeFaults;               // faults mapped with a huge page
+    size_t hugeFallbacks;            // ... that found no free block
+    size_t promotions;
+    size_t promotionFailures;        // automatic, for lack of a block
+    size_t pagesCopied;              // base pages copied by promotions
+    size_t demotions;
+    size_t walkReadsSaved;           // levels skipped at huge leaves
 
-public:
-    VirtualMemory(size_t pageSize, size_t physMemSize);
+    size_t allocateFrames(size_t order);     // evicts as needed
+    void evict(size_t frame);
+    uint64_t* walk(size_t vpn, size_t& order);
 
-    size_t translate(size_t virtualAddr);
-    void stats() const;
+    void mapFrames(size_t frame, size_t vpn, size_t order, uint64_t* entry);
+    void dropMapping(const PageTable::Mapping& mapping);
+    bool collapse(size_t vpn, size_t order, bool mayEvict);
+    uint32_t probeOrders() const;   // page orders the TLBs must probe
+
+    void linkNewest(size_t frame);
+    void unlink(size_t frame);
+    size_t chooseVictim();
+    void shootdown(const MappedPage& page);
 };
 
 #endif
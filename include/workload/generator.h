@@ -0,0 +1,157 @@
+#ifndef GENERATOR_H
+#define GENERATOR_H
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <string>
+#include <vector>
+#include "../memory.h"
+#include "../trace/trace.h"
+
+// ================= Distributions =================
+enum class SizeDistribution {
+    CLASSES,        // fixed size classes, each half as likely as the last
+    POWER_LAW,      // bounded Pareto: many small requests, a long tail
+    BIMODAL         // small objects plus a fraction of large buffers
+};
+
+enum class LifetimeModel {
+    LIFO,           // the newest live block is freed first (stack-like)
+    FIFO,           // the oldest live block is freed first (queue-like)
+    LONG_LIVED      // some blocks are never freed; the rest churn randomly
+};
+
+enum class WorkloadPattern {
+    MIXED,          // malloc / free by the lifetime model, Zipf accesses
+    PRODUCER_CONSUMER   // write a message, read it back later, free it
+};
+
+// "classes" / "powerlaw" / "bimodal", "lifo" / "fifo" / "longlived",
+// "mixed" / "producer-consumer"; false if unknown
+bool parseSizeDistribution(const std::string& text, SizeDistribution& out);
+bool parseLifetimeModel(const std::string& text, LifetimeModel& out);
+bool parseWorkloadPattern(const std::string& text, WorkloadPattern& out);
+const char* sizeDistributionName(SizeDistribution dist);
+const char* lifetimeModelName(LifetimeModel model);
+const char* workloadPatternName(WorkloadPattern pattern);
+
+// ================= Configuration =================
+struct WorkloadConfig {
+    uint64_t seed;
+    size_t ops;                 // malloc + free + read + write records
+
+    // ---------- Target ----------
+    TraceOp init;               // INIT_MEMORY, INIT_BUDDY or INIT_SLAB
+    size_t heapSize;
+    AllocatorType allocator;    // INIT_MEMORY only
+
+    // ---------- Sizes ----------
+    SizeDistribution sizes;
+    size_t minSize;
+    size_t maxSize;
+    double alpha;               // POWER_LAW tail exponent
+    double largeFraction;       // BIMODAL share of large requests
+
+    // ---------- Lifetimes ----------
+    LifetimeModel lifetime;
+    size_t liveTarget;          // live blocks the churn hovers around
+    double longLivedFraction;   // LONG_LIVED share never freed
+
+    // ---------- Accesses ----------
+    WorkloadPattern pattern;
+    double accessRatio;         // share of ops that are reads / writes
+    double writeRatio;          // share of accesses that are writes
+    double zipf;                // exponent over cache lines; 0 is uniform
+    size_t footprint;           // bytes the accesses spread over (0: heap)
+
+    WorkloadConfig();
+};
+
+// ================= Generator =================
+// A deterministic stream of simulator operations: the same config and
+// seed give the same records (splitmix64 and hand-written sampling, as
+// <random> distributions differ between standard libraries). The first
+// records initialise the target; after that next() yields `ops` malloc /
+// free / read / write records.
+//
+// Block ids are numbered 1, 2, ... in malloc order, as the simulator
+// hands them out while every malloc succeeds. A failed malloc takes no
+// id, so a consumer that can fail must map these ids to the ones it got
+// (memsim gen does); a trace replays them as they are.
+// getPeakLiveBytes() tells how large the live set got.
+//
+// Access addresses are not tied to blocks (their addresses depend on
+// the allocator): they fall on 64-byte lines of [0, footprint), with
+// Zipf-ranked lines scattered by a fixed permutation. Producer-consumer
+// messages own fixed slots of the footprint, so every message is read
+// back from the lines it was written to.
+class WorkloadGenerator {
+public:
+    static const size_t LINE = 64;
+    static const size_t MAX_MESSAGE_LINES = 8;
+
+    explicit WorkloadGenerator(const WorkloadConfig& config);
+
+    // false once the setup and `ops` operations have been produced
+    bool next(TraceRecord& record);
+
+    size_t getLive() const;
+    size_t getPeakLive() const;
+    size_t getPeakLiveBytes() const;
+
+private:
+    struct Message {
+        int id;
+        size_t slot;
+        size_t lines;
+    };
+
+    WorkloadConfig config;
+    uint64_t state;                 // PRNG
+
+    std::vector<TraceRecord> setup;
+    size_t setupPos;
+    size_t produced;
+
+    // ---------- Live blocks ----------
+    std::deque<int> live;           // freeable, in allocation order
+    std::vector<size_t> sizeOf;     // by id
+    size_t liveBlocks;              // allocated and not freed
+    size_t permanentBlocks;         // LONG_LIVED blocks never freed
+    size_t liveBytes;
+    size_t peakLive;
+    size_t peakLiveBytes;
+    int nextId;
+
+    // ---------- Producer-consumer ----------
+    std::deque<Message> queue;
+    size_t nextSlot;
+    size_t slotBytes;
+    std::vector<TraceRecord> pending;   // the rest of a message's lines
+    size_t pendingPos;
+
+    // ---------- Zipf (rejection-inversion sampling) ----------
+    size_t lines;
+    size_t stride;                  // rank -> line permutation
+    double hX1;
+    double hN;
+    double sConst;
+
+    uint64_t nextRandom();
+    double uniform();               // [0, 1)
+    size_t below(size_t n);         // [0, n)
+
+    size_t drawSize();
+    size_t drawLine();
+    double h(double x) const;
+    double hIntegral(double x) const;
+    double hIntegralInverse(double x) const;
+
+    void mixedOp(TraceRecord& record);
+    void producerConsumerOp(TraceRecord& record);
+    int allocate(TraceRecord& record, size_t size);
+    void release(TraceRecord& record, int id);
+};
+
+#endif
@@ -0,0 +1,59 @@
+#include "../include/block_pool.h"
+#include "../include/memory.h"
+
+// ---------- Constructor ----------
+BlockPool::BlockPool()
+    : chunkIndex(0),
+      chunkUsed(0),
+      freeList(nullptr),
+      live(0),
+      peak(0) {}
+
+// ---------- Acquire / Release ----------
+Block* BlockPool::acquire() {
+    Block* block;
+
+    if (freeList) {
+        block = freeList;
+        freeList = freeList->next;
+    } else {
+        if (chunkIndex < chunks.size() && chunkUsed == CHUNK_BLOCKS) {
+            chunkIndex++;
+            chunkUsed = 0;
+        }
+        if (chunkIndex == chunks.size())
+            chunks.emplace_back(new Block[CHUNK_BLOCKS]);
+
+        block = &chunks[chunkIndex][chunkUsed++];
+    }
+
+    live++;
+    if (live > peak)
+        peak = live;
+
+    return block;
+}
+
+void BlockPool::release(Block* block) {
+    block->next = freeList;
+    freeList = block;
+    live--;
+}
+
+// ---------- Reset ----------
+void BlockPool::reset() {
+    chunkIndex = 0;
+    chunkUsed = 0;
+    freeList = nullptr;
+    live = 0;
+    peak = 0;
+}
+
+// ---------- Stats ----------
+size_t BlockPool::inUse() const {
+    return live;
+}
+
+size_t BlockPool::highWaterMark() const {
+    return peak;
+}
@@ -0,0 +1,119 @@
+#include "../../include/buddy/block_bitmap.h"
+
+// ---------- Constructor ----------
+BlockBitmap::BlockBitmap()
+    : bits(0),
+      leafWords(0) {}
+
+void BlockBitmap::reset(size_t n) {
+    bits = n;
+    leafWords = (n + 63) / 64;
+
+    pages.clear();
+    pages.resize((leafWords + PAGE_WORDS - 1) / PAGE_WORDS);
+
+    // summary levels until a single word covers everything
+    summary.clear();
+    size_t words = leafWords;
+    while (words > 1) {
+        words = (words + 63) / 64;
+        summary.emplace_back(words, 0);
+    }
+}
+
+// ---------- Word access ----------
+// level 0 = leaf bits, level k = summary[k - 1]
+uint64_t BlockBitmap::leafWord(size_t w) const {
+    const std::unique_ptr<uint64_t[]>& page = pages[w / PAGE_WORDS];
+    return page ? page[w % PAGE_WORDS] : 0;
+}
+
+uint64_t BlockBitmap::word(size_t level, size_t index) const {
+    return level == 0 ? leafWord(index) : summary[level - 1][index];
+}
+
+size_t BlockBitmap::wordCount(size_t level) const {
+    return level == 0 ? leafWords : summary[level - 1].size();
+}
+
+// ---------- Update ----------
+void BlockBitmap::set(size_t bit) {
+    size_t w = bit / 64;
+    std::unique_ptr<uint64_t[]>& page = pages[w / PAGE_WORDS];
+    if (!page)
+        page.reset(new uint64_t[PAGE_WORDS]());
+
+    uint64_t& leaf = page[w % PAGE_WORDS];
+    bool wasEmpty = leaf == 0;
+    leaf |= 1ull << (bit % 64);
+
+    // propagate "non-empty" upwards until a word was already non-empty
+    for (size_t level = 0; wasEmpty && level < summary.size(); level++) {
+        uint64_t& s = summary[level][w / 64];
+        wasEmpty = s == 0;
+        s |= 1ull << (w % 64);
+        w /= 64;
+    }
+}
+
+void BlockBitmap::clear(size_t bit) {
+    size_t w = bit / 64;
+    std::unique_ptr<uint64_t[]>& page = pages[w / PAGE_WORDS];
+    if (!page)
+        return;
+
+    uint64_t& leaf = page[w % PAGE_WORDS];
+    leaf &= ~(1ull << (bit % 64));
+    bool nowEmpty = leaf == 0;
+
+    for (size_t level = 0; nowEmpty && level < summary.size(); level++) {
+        uint64_t& s = summary[level][w / 64];
+        s &= ~(1ull << (w % 64));
+        nowEmpty = s == 0;
+        w /= 64;
+    }
+}
+
+bool BlockBitmap::test(size_t bit) const {
+    if (bit >= bits)
+        return false;
+    return (leafWord(bit / 64) >> (bit % 64)) & 1;
+}
+
+// ---------- Search ----------
+bool BlockBitmap::empty() const {
+    if (leafWords == 0)
+        return true;
+    return word(summary.size(), 0) == 0;
+}
+
+// first set position >= pos at the given level
+size_t BlockBitmap::next(size_t level, size_t pos) const {
+    size_t w = pos / 64;
+    if (w >= wordCount(level))
+        return npos;
+
+    uint64_t bitsHere = word(level, w) & (~0ull << (pos % 64));
+    if (bitsHere)
+        return w * 64 + __builtin_ctzll(bitsHere);
+
+    if (level == summary.size())
+        return npos;
+
+    // ask the level above for the next non-empty word
+    size_t nextWord = next(level + 1, w + 1);
+    if (nextWord == npos)
+        return npos;
+
+    return nextWord * 64 + __builtin_ctzll(word(level, nextWord));
+}
+
+size_t BlockBitmap::findFirst() const {
+    return findNext(0);
+}
+
+size_t BlockBitmap::findNext(size_t bit) const {
+    if (bit >= bits)
+        return npos;
+    return next(0, bit);
+}
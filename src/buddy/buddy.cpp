@@ -8,34 +8,56 @@ BuddyAllocator::BuddyAllocator()
     : totalSize(0),
       maxOrder(0),
       nextId(1),
-      internalFragmentation(0) {}
+      internalFragmentation(0),
+      nonEmptyOrders(0),
+      lazyWatermark(0),
+      lazyCount(0),
+      splits(0),
+      merges(0),
+      splitsAvoided(0),
+      mergesAvoided(0),
+      sink(&defaultSink()) {}
 
 // ---------- Init ----------
 void BuddyAllocator::init(size_t size) {
+    reset(size);
+    sink->initialized(EventSource::BUDDY, size, 0);
+}
+
+void BuddyAllocator::setSink(EventSink* eventSink) {
+    sink = eventSink;
+}
+
+void BuddyAllocator::reset(size_t size) {
     totalSize = size;
     nextId = 1;
     internalFragmentation = 0;
 
     maxOrder = static_cast<int>(std::log2(size));
 
-    freeLists.clear();
-    freeLists.resize(maxOrder + 1);
-    allocated.clear();
+    freeMaps.clear();
+    freeMaps.resize(maxOrder + 1);
+    for (int i = 0; i <= maxOrder; i++)
+        freeMaps[i].reset(size >> i);
 
-    freeLists[maxOrder].insert(0);
+    allocated.assign(1, {0, -1, 0});
+    nonEmptyOrders = 0;
 
-    std::cout << "Buddy memory initialized: " << size << " bytes\n";
+    lazyLists.clear();
+    lazyLists.resize(maxOrder + 1);
+    lazyCount = 0;
+
+    splits = merges = 0;
+    splitsAvoided = mergesAvoided = 0;
+
+    markFree(0, maxOrder);
 }
 
 // ---------- Helpers ----------
 int BuddyAllocator::sizeToOrder(size_t size) const {
-    int order = 0;
-    size_t blockSize = 1;
-    while (blockSize < size) {
-        blockSize <<= 1;
-        order++;
-    }
-    return order;
+    if (size <= 1)
+        return 0;
+    return 64 - __builtin_clzll(size - 1);
 }
 
 size_t BuddyAllocator::orderToSize(int order) const {
@@ -46,95 +68,321 @@ size_t BuddyAllocator::buddyOf(size_t addr, int order) const {
     return addr ^ orderToSize(order);
 }
 
+void BuddyAllocator::markFree(size_t addr, int order) {
+    freeMaps[order].set(addr >> order);
+    nonEmptyOrders |= 1ull << order;
+}
+
+void BuddyAllocator::markUsed(size_t addr, int order) {
+    freeMaps[order].clear(addr >> order);
+    if (freeMaps[order].empty())
+        nonEmptyOrders &= ~(1ull << order);
+}
+
+bool BuddyAllocator::isFree(size_t addr, int order) const {
+    return freeMaps[order].test(addr >> order);
+}
+
+// merge a free block with its buddies as far as possible; reports the
+// resulting block even when nothing merged (a parked block is free now).
+// Returns the number of merges
+int BuddyAllocator::coalesce(size_t addr, int order) {
+    int count = 0;
+    while (order < maxOrder) {
+        size_t buddy = buddyOf(addr, order);
+
+        if (!isFree(buddy, order))
+            break;
+
+        markUsed(buddy, order);
+        addr = std::min(addr, buddy);
+        order++;
+        merges++;
+        count++;
+    }
+
+    markFree(addr, order);
+    sink->merged(EventSource::BUDDY, addr, orderToSize(order));
+    return count;
+}
+
+// merges coalesce() would perform right now, without doing them
+int BuddyAllocator::countMerges(size_t addr, int order) const {
+    int count = 0;
+    while (order < maxOrder && isFree(buddyOf(addr, order), order)) {
+        addr = std::min(addr, buddyOf(addr, order));
+        order++;
+        count++;
+    }
+    return count;
+}
+
+// ---------- Lazy coalescing ----------
+// merges a block taken off its lazy list. Only the merges eager mode
+// would have done that do not happen now were avoided; buddies freed
+// while it was parked can make it merge further than that
+void BuddyAllocator::unpark(const LazyBlock& blk, int order) {
+    int done = coalesce(blk.addr, order);
+    if (blk.pendingMerges > done)
+        mergesAvoided += blk.pendingMerges - done;
+}
+
+void BuddyAllocator::flushLazy() {
+    for (int order = 0; order < static_cast<int>(lazyLists.size()); order++) {
+        for (const LazyBlock& blk : lazyLists[order])
+            unpark(blk, order);
+        lazyLists[order].clear();
+    }
+    lazyCount = 0;
+}
+
+void BuddyAllocator::setLazy(size_t watermark) {
+    lazyWatermark = watermark;
+
+    if (watermark == 0) {
+        flushLazy();
+        return;
+    }
+
+    // trim lists that are now over the watermark, oldest first
+    for (int order = 0; order < static_cast<int>(lazyLists.size()); order++) {
+        std::deque<LazyBlock>& list = lazyLists[order];
+        while (list.size() > watermark) {
+            unpark(list.front(), order);
+            list.pop_front();
+            lazyCount--;
+        }
+    }
+}
+
 // ---------- Malloc ----------
-void BuddyAllocator::mallocBlock(size_t size) {
+// unlinks a free block of exactly `order`, splitting a larger one if
+// needed; -1 when nothing large enough is free
+size_t BuddyAllocator::takeBlock(int order) {
+    if (order > maxOrder)
+        return static_cast<size_t>(-1);
+
+    if (!lazyLists.empty() && !lazyLists[order].empty()) {
+        // reuse the most recently parked block of this order as-is
+        LazyBlock blk = lazyLists[order].back();
+        lazyLists[order].pop_back();
+        lazyCount--;
+
+        // eager mode would have merged it and split it back
+        mergesAvoided += blk.pendingMerges;
+        splitsAvoided += blk.pendingMerges;
+        return blk.addr;
+    }
+
+    // smallest non-empty order that can hold the request
+    uint64_t candidates = nonEmptyOrders & (~0ull << order);
+
+    if (!candidates && lazyCount > 0) {
+        // parked blocks may merge into something large enough
+        flushLazy();
+        candidates = nonEmptyOrders & (~0ull << order);
+    }
+
+    if (!candidates)
+        return static_cast<size_t>(-1);
+
+    int i = __builtin_ctzll(candidates);
+    size_t addr = freeMaps[i].findFirst() << i;
+    markUsed(addr, i);
+
+    // split blocks
+    while (i > order) {
+        i--;
+        size_t buddy = addr + orderToSize(i);
+        markFree(buddy, i);
+        splits++;
+        sink->split(EventSource::BUDDY, addr, orderToSize(i), orderToSize(i));
+    }
+    return addr;
+}
+
+size_t BuddyAllocator::allocate(size_t size, int& id) {
     int order = sizeToOrder(size);
+    size_t addr = takeBlock(order);
+    if (addr == static_cast<size_t>(-1))
+        return addr;
 
-    for (int i = order; i <= maxOrder; i++) {
-        if (!freeLists[i].empty()) {
-            size_t addr = *freeLists[i].begin();
-            freeLists[i].erase(addr);
+    size_t allocatedSize = orderToSize(order);
+    internalFragmentation += (allocatedSize - size);
 
-            // split blocks
-            while (i > order) {
-                i--;
-                size_t buddy = addr + orderToSize(i);
-                freeLists[i].insert(buddy);
-            }
+    allocated.push_back({
+        addr,
+        order,
+        size
+    });
 
-            size_t allocatedSize = orderToSize(order);
-            internalFragmentation += (allocatedSize - size);
+    id = nextId++;
+    return addr;
+}
 
-            allocated[nextId] = {
-                addr,
-                order,
-                size
-            };
+size_t BuddyAllocator::allocateOrder(int order) {
+    return takeBlock(order);
+}
 
-            std::cout << "Allocated block id=" << nextId
-                      << " at address=0x"
-                      << std::hex << addr
-                      << std::dec
-                      << " size=" << allocatedSize
-                      << "\n";
+int BuddyAllocator::mallocBlock(size_t size) {
+    int id;
+    size_t addr = allocate(size, id);
 
-            nextId++;
-            return;
-        }
+    if (addr == static_cast<size_t>(-1)) {
+        sink->allocationFailed(EventSource::BUDDY, size);
+        return -1;
     }
 
-    std::cout << "Allocation failed\n";
+    sink->allocated(EventSource::BUDDY, id, addr,
+                    orderToSize(allocated[id].order));
+    return id;
 }
 
 // ---------- Free ----------
-void BuddyAllocator::freeBlock(int id) {
-    auto it = allocated.find(id);
-    if (it == allocated.end()) {
-        std::cout << "Invalid block id\n";
+// coalesces the block, or parks it in lazy mode
+void BuddyAllocator::returnBlock(size_t addr, int order) {
+    if (lazyWatermark == 0) {
+        coalesce(addr, order);
         return;
     }
 
-    Block blk = it->second;
-    allocated.erase(it);
+    // park the block; merge the oldest one once the watermark is crossed
+    std::deque<LazyBlock>& list = lazyLists[order];
+    int pending = countMerges(addr, order);
 
-    size_t addr = blk.addr;
-    int order = blk.order;
+    list.push_back({addr, pending});
+    lazyCount++;
 
-    size_t allocatedSize = orderToSize(order);
+    if (list.size() > lazyWatermark) {
+        LazyBlock oldest = list.front();
+        list.pop_front();
+        lazyCount--;
+        unpark(oldest, order);
+    }
+}
+
+bool BuddyAllocator::isAllocated(int id) const {
+    return id > 0 && static_cast<size_t>(id) < allocated.size() &&
+           allocated[id].order >= 0;
+}
+
+bool BuddyAllocator::release(int id) {
+    if (!isAllocated(id))
+        return false;
+
+    Block blk = allocated[id];
+    allocated[id].order = -1;
+
+    size_t allocatedSize = orderToSize(blk.order);
     internalFragmentation -= (allocatedSize - blk.requestedSize);
 
-    // merge buddies
-    while (order < maxOrder) {
-        size_t buddy = buddyOf(addr, order);
-        auto freeIt = freeLists[order].find(buddy);
+    returnBlock(blk.addr, blk.order);
+    return true;
+}
 
-        if (freeIt == freeLists[order].end())
-            break;
+void BuddyAllocator::releaseOrder(size_t addr, int order) {
+    returnBlock(addr, order);
+}
 
-        freeLists[order].erase(freeIt);
-        addr = std::min(addr, buddy);
-        order++;
+void BuddyAllocator::freeBlock(int id) {
+    if (!isAllocated(id)) {
+        sink->invalidFree(EventSource::BUDDY, id);
+        return;
     }
 
-    freeLists[order].insert(addr);
-
-    std::cout << "Block " << id << " freed and merged\n";
+    // reported first, so the merges it causes follow the free
+    sink->freed(EventSource::BUDDY, id,
+                lazyWatermark > 0 ? FreeKind::DEFERRED : FreeKind::MERGED);
+    release(id);
 }
 
 // ---------- Dump ----------
 void BuddyAllocator::dump() const {
-    for (int i = 0; i <= maxOrder; i++) {
-        for (size_t addr : freeLists[i]) {
+    for (int i = 0; i < static_cast<int>(freeMaps.size()); i++) {
+        const BlockBitmap& map = freeMaps[i];
+
+        // parked blocks are free too; list them in address order with
+        // the rest of this order
+        std::vector<size_t> parked;
+        for (const LazyBlock& blk : lazyLists[i])
+            parked.push_back(blk.addr);
+        std::sort(parked.begin(), parked.end());
+
+        size_t p = 0;
+        size_t bit = map.findFirst();
+
+        while (bit != BlockBitmap::npos || p < parked.size()) {
+            bool lazy = bit == BlockBitmap::npos ||
+                        (p < parked.size() && parked[p] < (bit << i));
+
+            size_t addr;
+            if (lazy) {
+                addr = parked[p++];
+            } else {
+                addr = bit << i;
+                bit = map.findNext(bit + 1);
+            }
+
             std::cout << "[0x"
                       << std::hex << addr
                       << " - 0x"
                       << (addr + orderToSize(i) - 1)
-                      << "] FREE\n";
+                      << (lazy ? "] FREE (lazy)\n" : "] FREE\n");
         }
     }
+    std::cout << std::dec;
 }
 
 // ---------- Stats ----------
+void BuddyAllocator::stats() const {
+    std::cout << "Buddy Internal Fragmentation: "
+              << internalFragmentation
+              << " bytes\n";
+
+    if (lazyWatermark == 0)
+        return;
+
+    std::cout << std::dec
+              << "Lazy watermark: " << lazyWatermark << " blocks/order\n";
+    std::cout << "Parked blocks: " << lazyCount << "\n";
+    std::cout << "Splits: " << splits
+              << " (avoided " << splitsAvoided << ")\n";
+    std::cout << "Merges: " << merges
+              << " (avoided " << mergesAvoided << ")\n";
+}
+
 size_t BuddyAllocator::getInternalFragmentation() const {
     return internalFragmentation;
 }
+
+size_t BuddyAllocator::getSplits() const {
+    return splits;
+}
+
+size_t BuddyAllocator::getMerges() const {
+    return merges;
+}
+
+size_t BuddyAllocator::getSplitsAvoided() const {
+    return splitsAvoided;
+}
+
+size_t BuddyAllocator::getMergesAvoided() const {
+    return mergesAvoided;
+}
+
+int BuddyAllocator::getMaxOrder() const {
+    return maxOrder;
+}
+
+size_t BuddyAllocator::freeBlocks(int order) const {
+    if (order < 0 || order >= static_cast<int>(freeMaps.size()))
+        return 0;
+
+    size_t count = lazyLists[order].size();
+    const BlockBitmap& map = freeMaps[order];
+    for (size_t bit = map.findFirst(); bit != BlockBitmap::npos;
+         bit = map.findNext(bit + 1))
+        count++;
+    return count;
+}
@@ -1,148 +1,624 @@
 #include "../../include/cache/cache.h"
 #include <iostream>
+#include <cstring>
+#include <algorithm>
+#include <utility>
+#include <thread>
+
+#if defined(__x86_64__)
+#include <immintrin.h>
+#endif
 
 // ================= Constructor =================
-Cache::Cache(size_t numSets,
-             size_t associativity,
-             size_t blockSize,
-             const std::string& policy,
-             const std::string& name)
+static ReplacementPolicy decodePolicy(const std::string& name) {
+    ReplacementPolicy policy = ReplacementPolicy::FIFO;
+    parseReplacementPolicy(name, policy);
+    return policy;
+}
+
+template <typename G>
+BasicCache<G>::BasicCache(size_t numSets,
+                          size_t associativity,
+                          size_t blockSize,
+                          const std::string& policy,
+                          const std::string& name,
+                          uint64_t seed)
     : name(name),
-      numSets(numSets),
-      associativity(associativity),
-      blockSize(blockSize),
-      policy(policy),
-      sets(numSets, std::vector<CacheLine>(associativity)),
-      timer(0),
-      accesses(0),
-      hits(0),
-      misses(0),
-      evictions(0)
+      geometry(numSets, associativity, blockSize),
+      tags(geometry.sets() * geometry.ways(), 0),
+      valid(geometry.sets() * geometry.ways(), 0),
+      dirty(geometry.sets() * geometry.ways(), 0),
+      prefetched(geometry.sets() * geometry.ways(), 0),
+      displaced(geometry.sets() * geometry.ways(), 0),
+      replacement(decodePolicy(policy),
+                  geometry.sets(), geometry.ways(), seed)
 {
-    for (auto& set : sets) {
-        for (auto& line : set) {
-            line.valid = false;
-            line.tag = 0;
-            line.age = 0;
+    counters.clear();
+}
+
+// ================= Counters =================
+void CacheCounters::clear() {
+    *this = CacheCounters();
+}
+
+CacheCounters& CacheCounters::operator+=(const CacheCounters& other) {
+    accesses += other.accesses;
+    hits += other.hits;
+    misses += other.misses;
+    evictions += other.evictions;
+    writebacks += other.writebacks;
+    prefetchFills += other.prefetchFills;
+    prefetchUseful += other.prefetchUseful;
+    prefetchLate += other.prefetchLate;
+    prefetchPolluting += other.prefetchPolluting;
+    prefetchUnused += other.prefetchUnused;
+    return *this;
+}
+
+// ================= Helpers =================
+// Match bitmask of a whole set for a compile-time way count: one compare
+// per way, expanded by the fold expression, no loop left to run.
+template <size_t... W>
+static uint64_t matchMask(const size_t* setTags,
+                          const uint8_t* setValid,
+                          size_t tag,
+                          std::index_sequence<W...>) {
+    return ((static_cast<uint64_t>(setTags[W] == tag && setValid[W]) << W) |
+            ...);
+}
+
+// Runtime way count: tags are compared several ways at a time; a lane
+// only counts if the line is valid, and lanes are checked in way order
+// like the scalar loop.
+static int findWaySimd(const size_t* setTags,
+                       const uint8_t* setValid,
+                       size_t associativity,
+                       size_t tag) {
+    size_t w = 0;
+
+#if defined(__x86_64__) && defined(__AVX2__)
+    const __m256i key = _mm256_set1_epi64x(static_cast<long long>(tag));
+    for (; w + 4 <= associativity; w += 4) {
+        __m256i lanes = _mm256_loadu_si256(
+            reinterpret_cast<const __m256i*>(setTags + w));
+        int mask = _mm256_movemask_pd(
+            _mm256_castsi256_pd(_mm256_cmpeq_epi64(lanes, key)));
+
+        while (mask) {
+            int lane = __builtin_ctz(mask);
+            if (setValid[w + lane])
+                return static_cast<int>(w + lane);
+            mask &= mask - 1;
         }
     }
+#elif defined(__x86_64__)
+    // SSE2 has no 64-bit compare: compare 32-bit halves and require both
+    const __m128i key = _mm_set1_epi64x(static_cast<long long>(tag));
+    for (; w + 2 <= associativity; w += 2) {
+        __m128i lanes = _mm_loadu_si128(
+            reinterpret_cast<const __m128i*>(setTags + w));
+        __m128i eq = _mm_cmpeq_epi32(lanes, key);
+        eq = _mm_and_si128(eq, _mm_shuffle_epi32(eq, _MM_SHUFFLE(2, 3, 0, 1)));
+        int mask = _mm_movemask_pd(_mm_castsi128_pd(eq));
+
+        while (mask) {
+            int lane = __builtin_ctz(mask);
+            if (setValid[w + lane])
+                return static_cast<int>(w + lane);
+            mask &= mask - 1;
+        }
+    }
+#endif
+
+    for (; w < associativity; w++) {
+        if (setTags[w] == tag && setValid[w])
+            return static_cast<int>(w);
+    }
+    return -1;
 }
 
-// ================= Helpers =================
-size_t Cache::getSetIndex(size_t addr) const {
-    return (addr / blockSize) % numSets;
+// Way holding `tag` in the set starting at `base`, or -1.
+template <typename G>
+int BasicCache<G>::findWay(size_t base, size_t tag) const {
+    const size_t* setTags = tags.data() + base;
+    const uint8_t* setValid = valid.data() + base;
+
+    if constexpr (G::FIXED) {
+        uint64_t mask = matchMask(setTags, setValid, tag,
+                                  std::make_index_sequence<G::WAYS>{});
+        return mask ? __builtin_ctzll(mask) : -1;
+    } else {
+        return findWaySimd(setTags, setValid, geometry.ways(), tag);
+    }
 }
 
-size_t Cache::getTag(size_t addr) const {
-    return (addr / blockSize) / numSets;
+// ================= Access =================
+template <typename G>
+bool BasicCache<G>::access(size_t addr) {
+    if (lookup(addr, false))
+        return true;
+
+    CacheVictim victim;
+    fill(addr, false, victim);
+    return false;
+}
+
+// ================= Batch Access =================
+// Runs fn(0) .. fn(workers - 1), one per thread, fn(0) on the caller.
+template <typename Fn>
+static void runWorkers(size_t workers, const Fn& fn) {
+    std::vector<std::thread> threads;
+    for (size_t w = 1; w < workers; w++)
+        threads.emplace_back([&fn, w] { fn(w); });
+    fn(0);
+    for (std::thread& t : threads)
+        t.join();
 }
 
-// Select victim based on replacement policy (FIFO or LRU)
-int Cache::selectVictim(size_t setIndex) {
-    int victim = 0;
-    size_t bestAge = sets[setIndex][0].age;
+template <typename G>
+void BasicCache<G>::replaySlice(const size_t* addrs, const uint8_t* writes,
+                                size_t n, CacheCounters& tally) {
+    bool train;
+    CacheVictim victim;
+    for (size_t i = 0; i < n; i++) {
+        bool write = writes && writes[i];
+        if (!lookupLine(addrs[i], write, tally, train))
+            fillLine(addrs[i], write, victim, false, tally);
+    }
+}
+
+// Worker w owns the contiguous set range [w * sets / workers, ...), so it
+// sees exactly its sets' accesses in trace order. The batch is split in
+// two passes over equal input chunks, both parallel: count how many
+// addresses each chunk sends to each worker, then scatter them into one
+// buffer at prefix-sum offsets. Everything a worker writes during the
+// replay (lines, replacement state, its own counters) belongs to its
+// sets alone, so no locks or atomics are needed and results match the
+// serial loop exactly.
+template <typename G>
+void BasicCache<G>::accessBatch(const size_t* addrs, const uint8_t* writes,
+                                size_t count, size_t threads) {
+    // below this many accesses per worker, spawning threads costs more
+    // than it saves
+    static const size_t MIN_PER_WORKER = 1 << 16;
+
+    const size_t numSets = geometry.sets();
+    size_t workers = threads ? threads : std::thread::hardware_concurrency();
+    workers = std::min(workers, numSets);
+    workers = std::min(workers, count / MIN_PER_WORKER);
 
-    for (size_t i = 1; i < associativity; i++) {
-        if (sets[setIndex][i].age < bestAge) {
-            bestAge = sets[setIndex][i].age;
-            victim = static_cast<int>(i);
+    if (prefetcher || workers <= 1) {
+        CacheVictim victim;
+        for (size_t i = 0; i < count; i++) {
+            bool write = writes && writes[i];
+            if (!lookup(addrs[i], write))
+                fill(addrs[i], write, victim);
         }
+        return;
     }
-    return victim;
+
+    requests.clear();
+
+    auto owner = [&](size_t addr) {
+        return geometry.setIndex(addr) * workers / numSets;
+    };
+    auto chunkBegin = [&](size_t c) { return count * c / workers; };
+
+    // ---------- Pass 1: per-chunk counts ----------
+    // offsets[c * workers + w]: chunk c's addresses for worker w
+    std::vector<size_t> offsets(workers * workers, 0);
+    runWorkers(workers, [&](size_t c) {
+        size_t* row = offsets.data() + c * workers;
+        for (size_t i = chunkBegin(c); i < chunkBegin(c + 1); i++)
+            row[owner(addrs[i])]++;
+    });
+
+    // ---------- Prefix sums ----------
+    // worker-major, chunk-minor: each worker's substream is contiguous
+    // and keeps trace order
+    std::vector<size_t> sliceBegin(workers + 1, 0);
+    size_t total = 0;
+    for (size_t w = 0; w < workers; w++) {
+        sliceBegin[w] = total;
+        for (size_t c = 0; c < workers; c++) {
+            size_t n = offsets[c * workers + w];
+            offsets[c * workers + w] = total;
+            total += n;
+        }
+    }
+    sliceBegin[workers] = total;
+
+    // ---------- Pass 2: scatter ----------
+    // write flags travel with their addresses
+    std::vector<size_t> partitioned(count);
+    std::vector<uint8_t> partitionedWrites(writes ? count : 0);
+    runWorkers(workers, [&](size_t c) {
+        size_t* cursor = offsets.data() + c * workers;
+        for (size_t i = chunkBegin(c); i < chunkBegin(c + 1); i++) {
+            size_t slot = cursor[owner(addrs[i])]++;
+            partitioned[slot] = addrs[i];
+            if (writes)
+                partitionedWrites[slot] = writes[i];
+        }
+    });
+
+    // ---------- Replay ----------
+    std::vector<CacheCounters> tallies(workers);
+    runWorkers(workers, [&](size_t w) {
+        tallies[w].clear();
+        replaySlice(partitioned.data() + sliceBegin[w],
+                    writes ? partitionedWrites.data() + sliceBegin[w]
+                           : nullptr,
+                    sliceBegin[w + 1] - sliceBegin[w], tallies[w]);
+    });
+
+    for (const CacheCounters& tally : tallies)
+        counters += tally;
 }
 
-// ================= Access =================
-bool Cache::access(size_t addr) {
-    accesses++;
-    timer++;
+// ================= Hierarchy Primitives =================
+template <typename G>
+bool BasicCache<G>::lookup(size_t addr, bool write) {
+    requests.clear();
+
+    bool train = false;
+    bool hit = lookupLine(addr, write, counters, train);
+    if (train && prefetcher)
+        prefetcher->train(addr, requests);
+    return hit;
+}
+
+template <typename G>
+bool BasicCache<G>::fill(size_t addr, bool isDirty, CacheVictim& victim,
+                         bool prefetch) {
+    return fillLine(addr, isDirty, victim, prefetch, counters);
+}
 
-    size_t setIdx = getSetIndex(addr);
-    size_t tag = getTag(addr);
+template <typename G>
+bool BasicCache<G>::lookupLine(size_t addr, bool write,
+                               CacheCounters& tally, bool& train) {
+    tally.accesses++;
+
+    const size_t associativity = geometry.ways();
+    size_t set = geometry.setIndex(addr);
+    size_t base = set * associativity;
+    size_t tag = geometry.tag(addr);
+    int way = findWay(base, tag);
 
     // ---------- HIT ----------
-    for (auto& line : sets[setIdx]) {
-        if (line.valid && line.tag == tag) {
-            hits++;
-            if (policy == "LRU") {
-                line.age = timer;
-            }
-            return true;
+    if (way >= 0) {
+        tally.hits++;
+        replacement.onHit(set, way);
+        if (write)
+            dirty[base + way] = 1;
+
+        train = prefetched[base + way];
+        if (train) {
+            prefetched[base + way] = 0;
+            tally.prefetchUseful++;
         }
+        return true;
     }
 
     // ---------- MISS ----------
-    misses++;
+    tally.misses++;
 
-    // ---------- EMPTY SLOT ----------
-    for (auto& line : sets[setIdx]) {
-        if (!line.valid) {
-            line.valid = true;
-            line.tag = tag;
-            line.age = timer;
-            return false;
+    // counters.prefetchFills only changes outside batches, so reading it
+    // from a batch worker is safe
+    if (counters.prefetchFills) {
+        // was this line pushed out by a prefetch that is still resident?
+        for (size_t w = 0; w < associativity; w++) {
+            if (displaced[base + w] == tag + 1) {
+                displaced[base + w] = 0;
+                tally.prefetchPolluting++;
+                break;
+            }
         }
     }
 
-    // ---------- EVICTION ----------
-    int victim = selectVictim(setIdx);
-    evictions++;
+    train = true;
+    return false;
+}
 
-    sets[setIdx][victim].valid = true;
-    sets[setIdx][victim].tag = tag;
-    sets[setIdx][victim].age = timer;
+template <typename G>
+bool BasicCache<G>::fillLine(size_t addr, bool isDirty, CacheVictim& victim,
+                             bool prefetch, CacheCounters& tally) {
+    const size_t associativity = geometry.ways();
+    size_t set = geometry.setIndex(addr);
+    size_t base = set * associativity;
+    size_t tag = geometry.tag(addr);
+    bool evicted = false;
 
-    return false;
+    // already present (e.g. refilled by a write-back): just merge dirt
+    int way = findWay(base, tag);
+    if (way >= 0) {
+        dirty[base + way] |= isDirty;
+        return false;
+    }
+    size_t evictedTag = 0;
+
+    // ---------- EMPTY SLOT ----------
+    const void* empty = std::memchr(valid.data() + base, 0, associativity);
+    if (empty) {
+        way = static_cast<int>(
+            static_cast<const uint8_t*>(empty) - (valid.data() + base));
+    } else {
+        // ---------- EVICTION ----------
+        way = static_cast<int>(replacement.victim(set));
+        tally.evictions++;
+        evicted = true;
+
+        victim.addr = geometry.lineAddress(set, tags[base + way]);
+        victim.dirty = dirty[base + way];
+        if (victim.dirty)
+            tally.writebacks++;
+        if (prefetched[base + way])
+            tally.prefetchUnused++;
+        evictedTag = tags[base + way] + 1;
+    }
+
+    valid[base + way] = 1;
+    dirty[base + way] = isDirty;
+    tags[base + way] = tag;
+    replacement.onFill(set, way);
+
+    prefetched[base + way] = prefetch;
+    displaced[base + way] = prefetch ? evictedTag : 0;
+    if (prefetch)
+        tally.prefetchFills++;
+
+    return evicted;
+}
+
+template <typename G>
+bool BasicCache<G>::probe(size_t addr) const {
+    size_t base = geometry.setIndex(addr) * geometry.ways();
+    return findWay(base, geometry.tag(addr)) >= 0;
+}
+
+template <typename G>
+bool BasicCache<G>::invalidate(size_t addr, bool& wasDirty) {
+    size_t base = geometry.setIndex(addr) * geometry.ways();
+    int way = findWay(base, geometry.tag(addr));
+    if (way < 0)
+        return false;
+
+    wasDirty = dirty[base + way];
+    valid[base + way] = 0;
+    dirty[base + way] = 0;
+    if (prefetched[base + way])
+        counters.prefetchUnused++;
+    prefetched[base + way] = 0;
+    displaced[base + way] = 0;
+    return true;
+}
+
+template <typename G>
+bool BasicCache<G>::markDirty(size_t addr) {
+    size_t base = geometry.setIndex(addr) * geometry.ways();
+    int way = findWay(base, geometry.tag(addr));
+    if (way < 0)
+        return false;
+
+    dirty[base + way] = 1;
+    return true;
+}
+
+// ================= Prefetching =================
+template <typename G>
+void BasicCache<G>::setPrefetcher(std::unique_ptr<Prefetcher> p) {
+    prefetcher = std::move(p);
+}
+
+template <typename G>
+const Prefetcher* BasicCache<G>::getPrefetcher() const {
+    return prefetcher.get();
+}
+
+template <typename G>
+const std::vector<size_t>& BasicCache<G>::prefetchRequests() const {
+    return requests;
+}
+
+template <typename G>
+void BasicCache<G>::notePrefetchLate() {
+    counters.prefetchLate++;
 }
 
 // ================= Reset =================
-void Cache::reset() {
-    accesses = 0;
-    hits = 0;
-    misses = 0;
-    evictions = 0;
-    timer = 0;
-
-    for (auto& set : sets) {
-        for (auto& line : set) {
-            line.valid = false;
-            line.tag = 0;
-            line.age = 0;
-        }
-    }
+template <typename G>
+void BasicCache<G>::reset() {
+    counters.clear();
+
+    std::fill(tags.begin(), tags.end(), 0);
+    std::fill(valid.begin(), valid.end(), 0);
+    std::fill(dirty.begin(), dirty.end(), 0);
+    replacement.reset();
+
+    std::fill(prefetched.begin(), prefetched.end(), 0);
+    std::fill(displaced.begin(), displaced.end(), 0);
+    requests.clear();
+    if (prefetcher)
+        prefetcher->reset();
 }
 
 // ================= Stats =================
-void Cache::stats() const {
+template <typename G>
+void BasicCache<G>::stats() const {
     std::cout << "Cache Stats";
     if (!name.empty())
         std::cout << " (" << name << ")";
     std::cout << "\n";
 
-    std::cout << "Accesses : " << accesses << "\n";
-    std::cout << "Hits     : " << hits << "\n";
-    std::cout << "Misses   : " << misses << "\n";
-    std::cout << "Evictions: " << evictions << "\n";
+    std::cout << "Policy   : "
+              << replacementPolicyName(replacement.getPolicy()) << "\n";
+    std::cout << "Accesses : " << counters.accesses << "\n";
+    std::cout << "Hits     : " << counters.hits << "\n";
+    std::cout << "Misses   : " << counters.misses << "\n";
+    std::cout << "Evictions: " << counters.evictions << "\n";
+    std::cout << "Writebacks: " << counters.writebacks << "\n";
 
-    double hitRate = (accesses == 0)
+    double hitRate = (counters.accesses == 0)
+        ? 0.0
+        : (double)counters.hits / counters.accesses * 100.0;
+    double missRate = (counters.accesses == 0)
         ? 0.0
-        : (double)hits / accesses * 100.0;
+        : (double)counters.misses / counters.accesses * 100.0;
 
     std::cout << "Hit Rate : " << hitRate << "%\n";
+    std::cout << "Miss Rate: " << missRate << "%\n";
+
+    if (!prefetcher && counters.prefetchFills == 0 &&
+        counters.prefetchLate == 0)
+        return;
+
+    std::cout << "Prefetcher: "
+              << prefetcherTypeName(prefetcher ? prefetcher->getType()
+                                               : PrefetcherType::NONE);
+    if (prefetcher)
+        std::cout << " (degree " << prefetcher->getDegree() << ")";
+    std::cout << "\n";
+
+    double accuracy = (counters.prefetchFills == 0)
+        ? 0.0
+        : (double)counters.prefetchUseful / counters.prefetchFills * 100.0;
+
+    std::cout << "Prefetch fills     : " << counters.prefetchFills << "\n";
+    std::cout << "Prefetch useful    : " << counters.prefetchUseful << "\n";
+    std::cout << "Prefetch late      : " << counters.prefetchLate << "\n";
+    std::cout << "Prefetch polluting : " << counters.prefetchPolluting << "\n";
+    std::cout << "Prefetch unused    : " << counters.prefetchUnused << "\n";
+    std::cout << "Prefetch accuracy  : " << accuracy << "%\n";
 }
 
 // ================= Getters =================
-size_t Cache::getAccesses() const {
-    return accesses;
+template <typename G>
+size_t BasicCache<G>::getAccesses() const {
+    return counters.accesses;
 }
 
-size_t Cache::getHits() const {
-    return hits;
+template <typename G>
+size_t BasicCache<G>::getHits() const {
+    return counters.hits;
 }
 
-size_t Cache::getMisses() const {
-    return misses;
+template <typename G>
+size_t BasicCache<G>::getMisses() const {
+    return counters.misses;
 }
 
-size_t Cache::getEvictions() const {
-    return evictions;
+template <typename G>
+size_t BasicCache<G>::getEvictions() const {
+    return counters.evictions;
+}
+
+template <typename G>
+size_t BasicCache<G>::getWritebacks() const {
+    return counters.writebacks;
+}
+
+template <typename G>
+size_t BasicCache<G>::getPrefetchFills() const {
+    return counters.prefetchFills;
+}
+
+template <typename G>
+size_t BasicCache<G>::getPrefetchUseful() const {
+    return counters.prefetchUseful;
+}
+
+template <typename G>
+size_t BasicCache<G>::getPrefetchLate() const {
+    return counters.prefetchLate;
+}
+
+template <typename G>
+size_t BasicCache<G>::getPrefetchPolluting() const {
+    return counters.prefetchPolluting;
+}
+
+template <typename G>
+size_t BasicCache<G>::getSets() const {
+    return geometry.sets();
+}
+
+template <typename G>
+size_t BasicCache<G>::getWays() const {
+    return geometry.ways();
+}
+
+template <typename G>
+size_t BasicCache<G>::getBlockSize() const {
+    return geometry.block();
+}
+
+template <typename G>
+ReplacementPolicy BasicCache<G>::getPolicy() const {
+    return replacement.getPolicy();
+}
+
+template <typename G>
+const std::string& BasicCache<G>::getName() const {
+    return name;
+}
+
+// ================= Instantiations =================
+template class BasicCache<DynamicGeometry>;
+
+// Geometries with a compile-time specialisation: the L1 / L2 used by
+// main.cpp plus common 64-byte-line L1 / L2 / LLC shapes.
+template <typename... Geometries>
+struct GeometryList {};
+
+using FixedGeometries = GeometryList<
+    FixedGeometry<8, 2, 32>,
+    FixedGeometry<16, 4, 32>,
+    FixedGeometry<64, 4, 64>,
+    FixedGeometry<64, 8, 64>,
+    FixedGeometry<512, 8, 64>,
+    FixedGeometry<1024, 16, 64>,
+    FixedGeometry<2048, 16, 64>>;
+
+static std::unique_ptr<CacheModel> makeFixed(GeometryList<>,
+                                             size_t, size_t, size_t,
+                                             const std::string&,
+                                             const std::string&,
+                                             uint64_t) {
+    return nullptr;
+}
+
+template <typename G, typename... Rest>
+static std::unique_ptr<CacheModel> makeFixed(GeometryList<G, Rest...>,
+                                             size_t numSets,
+                                             size_t associativity,
+                                             size_t blockSize,
+                                             const std::string& policy,
+                                             const std::string& name,
+                                             uint64_t seed) {
+    if (numSets == G::sets() && associativity == G::ways() &&
+        blockSize == G::block()) {
+        return std::unique_ptr<CacheModel>(new BasicCache<G>(
+            numSets, associativity, blockSize, policy, name, seed));
+    }
+
+    return makeFixed(GeometryList<Rest...>{},
+                     numSets, associativity, blockSize, policy, name, seed);
+}
+
+// ================= Factory =================
+std::unique_ptr<CacheModel> makeCache(size_t numSets,
+                                      size_t associativity,
+                                      size_t blockSize,
+                                      const std::string& policy,
+                                      const std::string& name,
+                                      uint64_t seed) {
+    std::unique_ptr<CacheModel> cache = makeFixed(
+        FixedGeometries{}, numSets, associativity, blockSize,
+        policy, name, seed);
+
+    if (!cache) {
+        cache.reset(new Cache(numSets, associativity, blockSize,
+                              policy, name, seed));
+    }
+    return cache;
 }
@@ -0,0 +1,574 @@
+#include "../../include/cache/hierarchy.h"
+#include <algorithm>
+#include <cctype>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+// ================= Inclusion Policy =================
+bool parseInclusionPolicy(const std::string& text, InclusionPolicy& out) {
+    std::string lower = text;
+    std::transform(lower.begin(), lower.end(), lower.begin(),
+                   [](unsigned char c) { return std::tolower(c); });
+
+    if (lower == "inclusive")       out = InclusionPolicy::INCLUSIVE;
+    else if (lower == "exclusive")  out = InclusionPolicy::EXCLUSIVE;
+    else if (lower == "nine")       out = InclusionPolicy::NINE;
+    else return false;
+    return true;
+}
+
+const char* inclusionPolicyName(InclusionPolicy policy) {
+    switch (policy) {
+    case InclusionPolicy::INCLUSIVE:  return "inclusive";
+    case InclusionPolicy::EXCLUSIVE:  return "exclusive";
+    case InclusionPolicy::NINE:       return "NINE";
+    }
+    return "?";
+}
+
+// ================= Constructor =================
+CacheHierarchy::CacheHierarchy()
+    : inclusion(InclusionPolicy::NINE),
+      prefetchLatency(4),
+      reads(0),
+      writes(0),
+      memoryReads(0),
+      memoryWrites(0),
+      backInvalidations(0),
+      prefetchReads(0),
+      profiling(false),
+      sink(nullptr)
+{
+}
+
+// ================= Configuration =================
+bool CacheHierarchy::addLevel(const CacheLevelConfig& config) {
+    if (config.sets == 0 || config.ways == 0 || config.blockSize == 0) {
+        std::cout << "Error: cache sets, ways and block size must be positive\n";
+        return false;
+    }
+    if (config.ways > 4096) {
+        std::cout << "Error: at most 4096 ways per set\n";
+        return false;
+    }
+
+    ReplacementPolicy policy;
+    if (!parseReplacementPolicy(config.policy, policy)) {
+        std::cout << "Unknown replacement policy\n";
+        return false;
+    }
+
+    std::string name = config.name;
+    if (name.empty())
+        name = "L" + std::to_string(levels.size() + 1);
+
+    levels.push_back(makeCache(config.sets, config.ways, config.blockSize,
+                               config.policy, name, config.seed));
+    prefetch.push_back(PrefetchConfig{PrefetcherType::NONE, 1, false});
+    return true;
+}
+
+void CacheHierarchy::clear() {
+    levels.clear();
+    prefetch.clear();
+    reset();
+}
+
+bool CacheHierarchy::loadConfig(const std::string& path) {
+    std::ifstream in(path);
+    if (!in) {
+        std::cout << "Error: cannot open " << path << "\n";
+        return false;
+    }
+
+    // parse into a scratch hierarchy so a bad file changes nothing
+    CacheHierarchy parsed;
+    std::string line;
+    size_t lineNo = 0;
+
+    while (std::getline(in, line)) {
+        lineNo++;
+        line = line.substr(0, line.find('#'));
+
+        std::stringstream ss(line);
+        std::string directive;
+        if (!(ss >> directive))
+            continue;
+
+        if (directive == "level") {
+            CacheLevelConfig config;
+            std::string seedText;
+            config.seed = 1;
+            if (!(ss >> config.name >> config.sets >> config.ways
+                     >> config.blockSize >> config.policy)) {
+                std::cout << path << ":" << lineNo
+                          << ": expected level <name> <sets> <ways> <blockSize> <policy> [seed]\n";
+                return false;
+            }
+            if (ss >> seedText)
+                std::stringstream(seedText) >> config.seed;
+            if (!parsed.addLevel(config)) {
+                std::cout << path << ":" << lineNo << ": level rejected\n";
+                return false;
+            }
+        }
+        else if (directive == "prefetch") {
+            std::string levelName, type, target;
+            PrefetchConfig config{PrefetcherType::NONE, 1, false};
+            ss >> levelName >> type;
+
+            int level = parsed.findLevel(levelName);
+            if (level < 0 || !parsePrefetcherType(type, config.type)) {
+                std::cout << path << ":" << lineNo
+                          << ": expected prefetch <level> <none|next_line|stride|stream> [degree] [same|next]\n";
+                return false;
+            }
+            if (ss >> config.degree)
+                ss >> target;
+            config.toNext = (target == "next");
+            parsed.setPrefetcher(level, config);
+        }
+        else if (directive == "prefetch_latency") {
+            if (!(ss >> parsed.prefetchLatency)) {
+                std::cout << path << ":" << lineNo
+                          << ": expected prefetch_latency <requests>\n";
+                return false;
+            }
+        }
+        else if (directive == "inclusion") {
+            std::string mode;
+            ss >> mode;
+            if (!parseInclusionPolicy(mode, parsed.inclusion)) {
+                std::cout << path << ":" << lineNo
+                          << ": unknown inclusion policy\n";
+                return false;
+            }
+        }
+        else {
+            std::cout << path << ":" << lineNo
+                      << ": unknown directive '" << directive << "'\n";
+            return false;
+        }
+    }
+
+    if (parsed.levels.empty()) {
+        std::cout << "Error: " << path << " defines no cache levels\n";
+        return false;
+    }
+
+    levels = std::move(parsed.levels);
+    prefetch = std::move(parsed.prefetch);
+    inclusion = parsed.inclusion;
+    prefetchLatency = parsed.prefetchLatency;
+    reset();
+    return true;
+}
+
+void CacheHierarchy::setInclusion(InclusionPolicy policy) {
+    inclusion = policy;
+    reset();
+}
+
+InclusionPolicy CacheHierarchy::getInclusion() const {
+    return inclusion;
+}
+
+bool CacheHierarchy::setPolicy(size_t index,
+                               const std::string& policy,
+                               uint64_t seed) {
+    if (index >= levels.size())
+        return false;
+
+    const CacheModel& old = *levels[index];
+    levels[index] = makeCache(old.getSets(), old.getWays(),
+                              old.getBlockSize(), policy,
+                              old.getName(), seed);
+    attachPrefetcher(index);
+
+    // an emptied level would break inclusion, so start everything cold
+    reset();
+    return true;
+}
+
+bool CacheHierarchy::setPrefetcher(size_t index,
+                                   const PrefetchConfig& config) {
+    if (index >= levels.size())
+        return false;
+
+    prefetch[index] = config;
+    attachPrefetcher(index);
+    reset();
+    return true;
+}
+
+void CacheHierarchy::attachPrefetcher(size_t index) {
+    const PrefetchConfig& config = prefetch[index];
+    levels[index]->setPrefetcher(makePrefetcher(
+        config.type, levels[index]->getBlockSize(), config.degree));
+}
+
+void CacheHierarchy::setPrefetchLatency(size_t requests) {
+    prefetchLatency = requests;
+    reset();
+}
+
+size_t CacheHierarchy::getPrefetchLatency() const {
+    return prefetchLatency;
+}
+
+void CacheHierarchy::setSink(EventSink* eventSink) {
+    sink = eventSink;
+}
+
+void CacheHierarchy::setProfiling(bool enabled) {
+    profiling = enabled;
+    profile.reset(levels.empty() ? 32 : levels[0]->getBlockSize());
+}
+
+bool CacheHierarchy::isProfiling() const {
+    return profiling;
+}
+
+const StackDistanceProfiler& CacheHierarchy::getProfile() const {
+    return profile;
+}
+
+// ================= Helpers =================
+// Puts the line holding addr into `level` and deals with what it pushes out.
+void CacheHierarchy::install(size_t level, size_t addr, bool dirty,
+                             bool prefetched) {
+    CacheVictim victim;
+    bool evicted = levels[level]->fill(addr, dirty, victim, prefetched);
+
+    if (sink) {
+        const CacheModel& cache = *levels[level];
+        size_t block = cache.getBlockSize();
+        if (evicted)
+            sink->cacheEvicted(cache.getName(), victim.addr, victim.dirty);
+        sink->cacheFilled(cache.getName(), addr / block * block, prefetched);
+    }
+
+    if (evicted)
+        spill(level, victim);
+}
+
+// `victim` has just been evicted from `level`: move it further down.
+void CacheHierarchy::spill(size_t level, const CacheVictim& victim) {
+    bool dirty = victim.dirty;
+
+    if (inclusion == InclusionPolicy::INCLUSIVE) {
+        // drop every upper copy; the victim's line may span several
+        // smaller upper lines
+        size_t span = levels[level]->getBlockSize();
+        for (size_t upper = 0; upper < level; upper++) {
+            size_t step = levels[upper]->getBlockSize();
+            for (size_t a = victim.addr; a < victim.addr + span; a += step) {
+                bool upperDirty = false;
+                if (levels[upper]->invalidate(a, upperDirty)) {
+                    backInvalidations++;
+                    dirty |= upperDirty;
+                    if (sink)
+                        sink->cacheEvicted(levels[upper]->getName(),
+                                           a / step * step, upperDirty);
+                }
+            }
+        }
+    }
+
+    size_t next = level + 1;
+
+    if (inclusion == InclusionPolicy::EXCLUSIVE) {
+        // lower levels act as victim caches
+        if (next < levels.size())
+            install(next, victim.addr, dirty);
+        else if (dirty)
+            memoryWrites++;
+        return;
+    }
+
+    if (!dirty)
+        return;
+
+    if (next == levels.size()) {
+        memoryWrites++;
+        return;
+    }
+
+    // write-back: update the lower copy, allocating it if it is missing
+    if (!levels[next]->markDirty(victim.addr))
+        install(next, victim.addr, true);
+}
+
+// ================= Prefetching =================
+// Queues what `level`'s prefetcher asked for during its last lookup.
+void CacheHierarchy::issuePrefetches(size_t level) {
+    const std::vector<size_t>& requested = levels[level]->prefetchRequests();
+    if (requested.empty())
+        return;
+
+    // the last level has nothing below it, so it always fills itself
+    size_t target = level;
+    if (prefetch[level].toNext && level + 1 < levels.size())
+        target = level + 1;
+
+    size_t block = levels[target]->getBlockSize();
+    uint64_t now = reads + writes;
+
+    for (size_t addr : requested) {
+        if (inFlight.size() >= MAX_IN_FLIGHT)
+            break;
+        if (levels[target]->probe(addr))
+            continue;
+
+        bool queued = false;
+        for (const InFlight& f : inFlight) {
+            if (f.level == target && f.addr / block == addr / block) {
+                queued = true;
+                break;
+            }
+        }
+        if (!queued)
+            inFlight.push_back(InFlight{addr, target, now + prefetchLatency});
+    }
+}
+
+// Lands every prefetch whose latency has elapsed.
+void CacheHierarchy::completePrefetches() {
+    uint64_t now = reads + writes;
+    while (!inFlight.empty() && inFlight.front().ready <= now) {
+        InFlight f = inFlight.front();
+        inFlight.pop_front();
+        installPrefetch(f.level, f.addr);
+    }
+}
+
+void CacheHierarchy::installPrefetch(size_t level, size_t addr) {
+    if (levels[level]->probe(addr))
+        return;
+
+    // where does the data come from?
+    bool below = false;
+    for (size_t l = level + 1; l < levels.size() && !below; l++)
+        below = levels[l]->probe(addr);
+
+    if (inclusion == InclusionPolicy::EXCLUSIVE) {
+        // one copy only: a line already held further down stays there
+        for (size_t l = 0; l < level; l++) {
+            if (levels[l]->probe(addr))
+                return;
+        }
+        if (below)
+            return;
+    }
+
+    if (!below)
+        prefetchReads++;
+
+    if (inclusion == InclusionPolicy::INCLUSIVE) {
+        for (size_t l = levels.size(); l-- > level + 1; ) {
+            if (!levels[l]->probe(addr))
+                install(l, addr, false);
+        }
+    }
+
+    install(level, addr, false, true);
+}
+
+// A demand miss in `level` on a line still in flight there: the demand
+// fetch supersedes the prefetch.
+bool CacheHierarchy::cancelInFlight(size_t level, size_t addr) {
+    size_t block = levels[level]->getBlockSize();
+    for (auto it = inFlight.begin(); it != inFlight.end(); ++it) {
+        if (it->level == level && it->addr / block == addr / block) {
+            inFlight.erase(it);
+            return true;
+        }
+    }
+    return false;
+}
+
+// ================= Access =================
+int CacheHierarchy::access(size_t addr, bool write) {
+    if (write)
+        writes++;
+    else
+        reads++;
+
+    if (profiling)
+        profile.access(addr);
+
+    if (levels.empty()) {
+        if (write)
+            memoryWrites++;
+        else
+            memoryReads++;
+        return -1;
+    }
+
+    completePrefetches();
+
+    // only the first level sees the write; below it is a line fetch
+    size_t hit = 0;
+    while (hit < levels.size()) {
+        bool found = levels[hit]->lookup(addr, write && hit == 0);
+
+        if (!found && !inFlight.empty() && cancelInFlight(hit, addr))
+            levels[hit]->notePrefetchLate();
+        issuePrefetches(hit);
+
+        if (found)
+            break;
+        hit++;
+    }
+
+    if (hit == 0)
+        return 0;
+
+    if (hit == levels.size())
+        memoryReads++;
+
+    if (inclusion == InclusionPolicy::EXCLUSIVE) {
+        bool dirty = write;
+        if (hit < levels.size()) {
+            bool wasDirty = false;
+            levels[hit]->invalidate(addr, wasDirty);
+            dirty |= wasDirty;
+            if (sink) {
+                size_t block = levels[hit]->getBlockSize();
+                sink->cacheEvicted(levels[hit]->getName(),
+                                   addr / block * block, wasDirty);
+            }
+        }
+        install(0, addr, dirty);
+    }
+    else {
+        // fill bottom-up so an inclusive upper level never holds a line
+        // its lower level is missing
+        for (size_t level = hit; level-- > 0; )
+            install(level, addr, write && level == 0);
+    }
+
+    return hit == levels.size() ? -1 : static_cast<int>(hit);
+}
+
+void CacheHierarchy::accessBatch(const size_t* addrs, const uint8_t* isWrite,
+                                 size_t count, size_t threads) {
+    bool single = levels.size() == 1 && !levels[0]->getPrefetcher() &&
+                  inFlight.empty() && !profiling && !sink;
+    if (!single) {
+        for (size_t i = 0; i < count; i++)
+            access(addrs[i], isWrite && isWrite[i]);
+        return;
+    }
+
+    // with one level every miss is a memory read and every dirty
+    // eviction a memory write, whatever the inclusion policy
+    CacheModel& cache = *levels[0];
+    size_t misses = cache.getMisses();
+    size_t writebacks = cache.getWritebacks();
+
+    cache.accessBatch(addrs, isWrite, count, threads);
+
+    size_t written = 0;
+    for (size_t i = 0; isWrite && i < count; i++)
+        written += isWrite[i] != 0;
+    writes += written;
+    reads += count - written;
+    memoryReads += cache.getMisses() - misses;
+    memoryWrites += cache.getWritebacks() - writebacks;
+}
+
+// ================= Reset =================
+void CacheHierarchy::reset() {
+    for (auto& cache : levels)
+        cache->reset();
+
+    reads = 0;
+    writes = 0;
+    memoryReads = 0;
+    memoryWrites = 0;
+    backInvalidations = 0;
+    prefetchReads = 0;
+    inFlight.clear();
+
+    profile.reset(levels.empty() ? 32 : levels[0]->getBlockSize());
+}
+
+// ================= Stats =================
+void CacheHierarchy::stats() const {
+    std::cout << std::dec;
+    std::cout << "Levels   : " << levels.size()
+              << " (" << inclusionPolicyName(inclusion)
+              << ", write-back, write-allocate)\n";
+
+    bool prefetching = false;
+    for (const PrefetchConfig& config : prefetch)
+        prefetching |= config.type != PrefetcherType::NONE;
+    if (prefetching)
+        std::cout << "Prefetch latency: " << prefetchLatency
+                  << " requests\n";
+
+    for (const auto& cache : levels) {
+        std::cout << "\n";
+        cache->stats();
+    }
+
+    size_t requests = reads + writes;
+    double missRate = (requests == 0)
+        ? 0.0
+        : (double)memoryReads / requests * 100.0;
+
+    std::cout << "\nOverall\n";
+    std::cout << "Requests     : " << requests
+              << " (" << reads << " reads, " << writes << " writes)\n";
+    std::cout << "Memory reads : " << memoryReads << "\n";
+    std::cout << "Memory writes: " << memoryWrites << "\n";
+    if (inclusion == InclusionPolicy::INCLUSIVE)
+        std::cout << "Back-invalidations: " << backInvalidations << "\n";
+    if (prefetching)
+        std::cout << "Prefetch reads: " << prefetchReads << "\n";
+    std::cout << "Miss Rate    : " << missRate << "%\n";
+}
+
+// ================= Getters =================
+size_t CacheHierarchy::numLevels() const {
+    return levels.size();
+}
+
+const CacheModel& CacheHierarchy::level(size_t index) const {
+    return *levels[index];
+}
+
+int CacheHierarchy::findLevel(const std::string& text) const {
+    for (size_t i = 0; i < levels.size(); i++) {
+        const std::string& name = levels[i]->getName();
+        if (name.size() == text.size() &&
+            std::equal(name.begin(), name.end(), text.begin(),
+                       [](unsigned char a, unsigned char b) {
+                           return std::tolower(a) == std::tolower(b);
+                       }))
+            return static_cast<int>(i);
+    }
+
+    // "l<n>" falls back to position when no level has that name
+    if (text.size() >= 2 && (text[0] == 'l' || text[0] == 'L')) {
+        size_t n = 0;
+        std::stringstream(text.substr(1)) >> n;
+        if (n >= 1 && n <= levels.size())
+            return static_cast<int>(n - 1);
+    }
+    return -1;
+}
+
+size_t CacheHierarchy::getRequests() const {
+    return reads + writes;
+}
+
+size_t CacheHierarchy::getMemoryReads() const {
+    return memoryReads;
+}
+
+size_t CacheHierarchy::getMemoryWrites() const {
+    return memoryWrites;
+}
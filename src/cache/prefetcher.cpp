@@ -0,0 +1,169 @@
+#include "../../include/cache/prefetcher.h"
+#include <algorithm>
+#include <cctype>
+
+// ================= Prefetcher Type =================
+bool parsePrefetcherType(const std::string& text, PrefetcherType& out) {
+    std::string lower = text;
+    std::transform(lower.begin(), lower.end(), lower.begin(),
+                   [](unsigned char c) { return std::tolower(c); });
+
+    if (lower == "none")            out = PrefetcherType::NONE;
+    else if (lower == "next_line")  out = PrefetcherType::NEXT_LINE;
+    else if (lower == "stride")     out = PrefetcherType::STRIDE;
+    else if (lower == "stream")     out = PrefetcherType::STREAM;
+    else return false;
+    return true;
+}
+
+const char* prefetcherTypeName(PrefetcherType type) {
+    switch (type) {
+    case PrefetcherType::NONE:       return "none";
+    case PrefetcherType::NEXT_LINE:  return "next_line";
+    case PrefetcherType::STRIDE:     return "stride";
+    case PrefetcherType::STREAM:     return "stream";
+    }
+    return "?";
+}
+
+// ================= Next-Line =================
+NextLinePrefetcher::NextLinePrefetcher(size_t blockSize, size_t degree)
+    : Prefetcher(blockSize, degree) {}
+
+void NextLinePrefetcher::train(size_t addr, std::vector<size_t>& out) {
+    size_t line = addr / blockSize;
+    for (size_t i = 1; i <= degree; i++)
+        out.push_back((line + i) * blockSize);
+}
+
+void NextLinePrefetcher::reset() {}
+
+PrefetcherType NextLinePrefetcher::getType() const {
+    return PrefetcherType::NEXT_LINE;
+}
+
+// ================= Stride =================
+StridePrefetcher::StridePrefetcher(size_t blockSize, size_t degree)
+    : Prefetcher(blockSize, degree) {
+    reset();
+}
+
+void StridePrefetcher::reset() {
+    table.assign(ENTRIES, Entry{false, 0, 0, 0, 0, 0});
+    clock = 0;
+}
+
+void StridePrefetcher::train(size_t addr, std::vector<size_t>& out) {
+    size_t line = addr / blockSize;
+    size_t region = addr >> REGION_SHIFT;
+    clock++;
+
+    // ---------- Find or replace the region's entry ----------
+    Entry* entry = nullptr;
+    Entry* oldest = &table[0];
+    for (Entry& e : table) {
+        if (e.valid && e.region == region) {
+            entry = &e;
+            break;
+        }
+        if (!e.valid || (oldest->valid && e.lastUse < oldest->lastUse))
+            oldest = &e;
+    }
+
+    if (!entry) {
+        *oldest = Entry{true, region, line, 0, 0, clock};
+        return;
+    }
+
+    // ---------- Update stride and confidence ----------
+    long long stride = static_cast<long long>(line) -
+                       static_cast<long long>(entry->lastLine);
+    if (stride != 0 && stride == entry->stride) {
+        entry->confidence = std::min(entry->confidence + 1, 3);
+    } else {
+        entry->stride = stride;
+        entry->confidence = 0;
+    }
+    entry->lastLine = line;
+    entry->lastUse = clock;
+
+    if (entry->confidence == 0)
+        return;
+
+    for (size_t i = 1; i <= degree; i++) {
+        long long target = static_cast<long long>(line) +
+                           entry->stride * static_cast<long long>(i);
+        if (target < 0)
+            break;
+        out.push_back(static_cast<size_t>(target) * blockSize);
+    }
+}
+
+PrefetcherType StridePrefetcher::getType() const {
+    return PrefetcherType::STRIDE;
+}
+
+// ================= Stream =================
+StreamPrefetcher::StreamPrefetcher(size_t blockSize, size_t degree)
+    : Prefetcher(blockSize, degree) {
+    reset();
+}
+
+void StreamPrefetcher::reset() {
+    streams.assign(STREAMS, Stream{false, 0, 0, 0});
+    clock = 0;
+}
+
+void StreamPrefetcher::train(size_t addr, std::vector<size_t>& out) {
+    size_t line = addr / blockSize;
+    clock++;
+
+    Stream* stream = nullptr;
+    Stream* oldest = &streams[0];
+    for (Stream& s : streams) {
+        if (s.valid && line > s.lastLine && line <= s.nextLine) {
+            stream = &s;
+            break;
+        }
+        if (!s.valid || (oldest->valid && s.lastUse < oldest->lastUse))
+            oldest = &s;
+    }
+
+    if (!stream) {
+        stream = oldest;
+        *stream = Stream{true, line, line + 1, 0};
+    }
+
+    stream->lastLine = line;
+    stream->lastUse = clock;
+
+    // keep the stream `degree` lines ahead of the demand stream
+    for (; stream->nextLine <= line + degree; stream->nextLine++) {
+        if (stream->nextLine > line)
+            out.push_back(stream->nextLine * blockSize);
+    }
+}
+
+PrefetcherType StreamPrefetcher::getType() const {
+    return PrefetcherType::STREAM;
+}
+
+// ================= Factory =================
+std::unique_ptr<Prefetcher> makePrefetcher(PrefetcherType type,
+                                           size_t blockSize,
+                                           size_t degree) {
+    switch (type) {
+    case PrefetcherType::NEXT_LINE:
+        return std::unique_ptr<Prefetcher>(
+            new NextLinePrefetcher(blockSize, degree));
+    case PrefetcherType::STRIDE:
+        return std::unique_ptr<Prefetcher>(
+            new StridePrefetcher(blockSize, degree));
+    case PrefetcherType::STREAM:
+        return std::unique_ptr<Prefetcher>(
+            new StreamPrefetcher(blockSize, degree));
+    case PrefetcherType::NONE:
+        break;
+    }
+    return nullptr;
+}
@@ -0,0 +1,306 @@
+#include "../../include/cache/replacement.h"
+#include <cctype>
+
+// ================= Names =================
+bool parseReplacementPolicy(const std::string& text, ReplacementPolicy& out) {
+    std::string upper;
+    for (char c : text)
+        upper += static_cast<char>(std::toupper(static_cast<unsigned char>(c)));
+
+    if (upper == "LRU")         out = ReplacementPolicy::LRU;
+    else if (upper == "FIFO")   out = ReplacementPolicy::FIFO;
+    else if (upper == "PLRU")   out = ReplacementPolicy::PLRU;
+    else if (upper == "SRRIP")  out = ReplacementPolicy::SRRIP;
+    else if (upper == "BRRIP")  out = ReplacementPolicy::BRRIP;
+    else if (upper == "RANDOM") out = ReplacementPolicy::RANDOM;
+    else if (upper == "LFU")    out = ReplacementPolicy::LFU;
+    else return false;
+
+    return true;
+}
+
+const char* replacementPolicyName(ReplacementPolicy policy) {
+    switch (policy) {
+    case ReplacementPolicy::LRU:    return "LRU";
+    case ReplacementPolicy::FIFO:   return "FIFO";
+    case ReplacementPolicy::PLRU:   return "PLRU";
+    case ReplacementPolicy::SRRIP:  return "SRRIP";
+    case ReplacementPolicy::BRRIP:  return "BRRIP";
+    case ReplacementPolicy::RANDOM: return "RANDOM";
+    case ReplacementPolicy::LFU:    return "LFU";
+    }
+    return "?";
+}
+
+// ================= Constructor =================
+ReplacementState::ReplacementState(ReplacementPolicy policy,
+                                   size_t numSets,
+                                   size_t ways,
+                                   uint64_t seed)
+    : policy(policy),
+      numSets(numSets),
+      ways(ways),
+      seed(seed),
+      leaves(1)
+{
+    bool maskBased = policy == ReplacementPolicy::PLRU ||
+                     policy == ReplacementPolicy::SRRIP ||
+                     policy == ReplacementPolicy::BRRIP ||
+                     policy == ReplacementPolicy::LFU;
+    if (maskBased && ways > 64)
+        this->policy = ReplacementPolicy::LRU;
+
+    while (leaves < ways)
+        leaves <<= 1;
+
+    reset();
+}
+
+size_t ReplacementState::levels() const {
+    switch (policy) {
+    case ReplacementPolicy::SRRIP:
+    case ReplacementPolicy::BRRIP:
+        return RRPV_MAX + 1;
+    case ReplacementPolicy::LFU:
+        return LFU_MAX + 1;
+    default:
+        return 0;
+    }
+}
+
+ReplacementPolicy ReplacementState::getPolicy() const {
+    return policy;
+}
+
+// ================= Reset =================
+void ReplacementState::reset() {
+    prevWay.clear();
+    nextWay.clear();
+    head.clear();
+    tail.clear();
+    treeBits.clear();
+    level.clear();
+    levelMasks.clear();
+    nonEmpty.clear();
+    fills.clear();
+    rng.clear();
+
+    uint64_t full = ways >= 64 ? ~0ull : (1ull << ways) - 1;
+
+    switch (policy) {
+    case ReplacementPolicy::LRU:
+    case ReplacementPolicy::FIFO:
+        // every set starts as the list 0 -> 1 -> ... -> ways-1
+        prevWay.resize(numSets * ways);
+        nextWay.resize(numSets * ways);
+        head.assign(numSets, 0);
+        tail.assign(numSets, static_cast<uint16_t>(ways - 1));
+        for (size_t s = 0; s < numSets; s++) {
+            for (size_t w = 0; w < ways; w++) {
+                prevWay[s * ways + w] = w == 0 ? NONE : w - 1;
+                nextWay[s * ways + w] = w + 1 == ways ? NONE : w + 1;
+            }
+        }
+        break;
+
+    case ReplacementPolicy::PLRU:
+        treeBits.assign(numSets, 0);
+        break;
+
+    case ReplacementPolicy::SRRIP:
+    case ReplacementPolicy::BRRIP:
+        // all lines start "distant"
+        levelMasks.assign(numSets * levels(), 0);
+        for (size_t s = 0; s < numSets; s++)
+            levelMasks[s * levels() + RRPV_MAX] = full;
+        fills.assign(numSets, 0);
+        break;
+
+    case ReplacementPolicy::LFU:
+        level.assign(numSets * ways, 0);
+        levelMasks.assign(numSets * levels(), 0);
+        nonEmpty.assign(numSets, 1);
+        for (size_t s = 0; s < numSets; s++)
+            levelMasks[s * levels()] = full;
+        break;
+
+    case ReplacementPolicy::RANDOM:
+        rng.resize(numSets);
+        for (size_t s = 0; s < numSets; s++) {
+            // splitmix64 of (seed, set) so every set has its own stream
+            uint64_t z = seed + (s + 1) * 0x9E3779B97F4A7C15ull;
+            z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+            z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+            rng[s] = (z ^ (z >> 31)) | 1;
+        }
+        break;
+    }
+}
+
+// ================= Helpers =================
+void ReplacementState::moveToFront(size_t set, size_t way) {
+    if (head[set] == way)
+        return;
+
+    size_t base = set * ways;
+    uint16_t prev = prevWay[base + way];
+    uint16_t next = nextWay[base + way];
+
+    // unlink (way is not the head, so prev exists)
+    nextWay[base + prev] = next;
+    if (next != NONE)
+        prevWay[base + next] = prev;
+    else
+        tail[set] = prev;
+
+    // relink as most recent
+    prevWay[base + way] = NONE;
+    nextWay[base + way] = head[set];
+    prevWay[base + head[set]] = static_cast<uint16_t>(way);
+    head[set] = static_cast<uint16_t>(way);
+}
+
+void ReplacementState::setLevel(size_t set, size_t way, int value) {
+    uint64_t* masks = &levelMasks[set * levels()];
+    uint64_t bit = 1ull << way;
+
+    if (policy == ReplacementPolicy::LFU) {
+        int old = level[set * ways + way];
+        masks[old] &= ~bit;
+        if (!masks[old])
+            nonEmpty[set] &= ~(1u << old);
+
+        level[set * ways + way] = static_cast<uint8_t>(value);
+        nonEmpty[set] |= 1u << value;
+    } else {
+        // RRPVs age in bulk, so the current value lives only in the masks
+        for (int l = 0; l <= RRPV_MAX; l++)
+            masks[l] &= ~bit;
+    }
+
+    masks[value] |= bit;
+}
+
+// point every tree node on the way's path away from it
+void ReplacementState::touchTree(size_t set, size_t way) {
+    uint64_t bits = treeBits[set];
+
+    for (size_t n = leaves + way; n > 1; n >>= 1) {
+        size_t parent = n >> 1;
+        if (n & 1)
+            bits &= ~(1ull << parent);   // came from the right: go left
+        else
+            bits |= 1ull << parent;      // came from the left: go right
+    }
+
+    treeBits[set] = bits;
+}
+
+size_t ReplacementState::treeVictim(size_t set) const {
+    uint64_t bits = treeBits[set];
+    size_t n = 1;
+
+    while (n < leaves) {
+        size_t child = 2 * n + ((bits >> n) & 1);
+
+        // with a non power-of-two way count, skip subtrees with no ways
+        size_t first = child;
+        while (first < leaves)
+            first <<= 1;
+        if (first - leaves >= ways)
+            child ^= 1;
+
+        n = child;
+    }
+
+    return n - leaves;
+}
+
+// ================= Events =================
+void ReplacementState::onHit(size_t set, size_t way) {
+    switch (policy) {
+    case ReplacementPolicy::LRU:
+        moveToFront(set, way);
+        break;
+    case ReplacementPolicy::PLRU:
+        touchTree(set, way);
+        break;
+    case ReplacementPolicy::SRRIP:
+    case ReplacementPolicy::BRRIP:
+        setLevel(set, way, 0);
+        break;
+    case ReplacementPolicy::LFU: {
+        int count = level[set * ways + way];
+        if (count < LFU_MAX)
+            setLevel(set, way, count + 1);
+        break;
+    }
+    case ReplacementPolicy::FIFO:
+    case ReplacementPolicy::RANDOM:
+        break;
+    }
+}
+
+void ReplacementState::onFill(size_t set, size_t way) {
+    switch (policy) {
+    case ReplacementPolicy::LRU:
+    case ReplacementPolicy::FIFO:
+        moveToFront(set, way);
+        break;
+    case ReplacementPolicy::PLRU:
+        touchTree(set, way);
+        break;
+    case ReplacementPolicy::SRRIP:
+        setLevel(set, way, RRPV_MAX - 1);
+        break;
+    case ReplacementPolicy::BRRIP:
+        // mostly insert at distant, occasionally at long re-reference
+        setLevel(set, way,
+                 fills[set]++ % BRRIP_THROTTLE == 0 ? RRPV_MAX - 1
+                                                    : RRPV_MAX);
+        break;
+    case ReplacementPolicy::LFU:
+        setLevel(set, way, 1);
+        break;
+    case ReplacementPolicy::RANDOM:
+        break;
+    }
+}
+
+size_t ReplacementState::victim(size_t set) {
+    switch (policy) {
+    case ReplacementPolicy::LRU:
+    case ReplacementPolicy::FIFO:
+        return tail[set];
+
+    case ReplacementPolicy::PLRU:
+        return treeVictim(set);
+
+    case ReplacementPolicy::SRRIP:
+    case ReplacementPolicy::BRRIP: {
+        uint64_t* masks = &levelMasks[set * levels()];
+        // age the whole set until some line is distant
+        while (!masks[RRPV_MAX]) {
+            for (int l = RRPV_MAX; l > 0; l--)
+                masks[l] = masks[l - 1];
+            masks[0] = 0;
+        }
+        return __builtin_ctzll(masks[RRPV_MAX]);
+    }
+
+    case ReplacementPolicy::LFU: {
+        int lowest = __builtin_ctz(nonEmpty[set]);
+        return __builtin_ctzll(levelMasks[set * levels() + lowest]);
+    }
+
+    case ReplacementPolicy::RANDOM: {
+        uint64_t& x = rng[set];
+        x ^= x >> 12;
+        x ^= x << 25;
+        x ^= x >> 27;
+        return (x * 0x2545F4914F6CDD1Dull) % ways;
+    }
+    }
+
+    return 0;
+}
@@ -0,0 +1,237 @@
+#include "../../include/cache/stack_distance.h"
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+
+// ================= Reuse Stack =================
+ReuseStack::ReuseStack() {
+    reset();
+}
+
+void ReuseStack::reset() {
+    owner.clear();
+    tree.assign(1, 0);
+    live = 0;
+}
+
+void ReuseStack::add(size_t slot, int delta) {
+    for (size_t i = slot + 1; i < tree.size(); i += i & (~i + 1))
+        tree[i] += delta;
+}
+
+size_t ReuseStack::prefix(size_t slot) const {
+    size_t sum = 0;
+    for (size_t i = slot + 1; i > 0; i -= i & (~i + 1))
+        sum += tree[i];
+    return sum;
+}
+
+// Renumbers the live lines to slots 0..live-1, in access order, inside a
+// tree of `capacity` slots.
+void ReuseStack::rebuild(size_t capacity) {
+    std::vector<uint32_t*> compacted;
+    compacted.reserve(capacity);
+    for (uint32_t* slot : owner) {
+        if (slot) {
+            *slot = static_cast<uint32_t>(compacted.size());
+            compacted.push_back(slot);
+        }
+    }
+    owner.swap(compacted);
+
+    // every remaining slot is marked: build the Fenwick tree in O(n)
+    tree.assign(capacity + 1, 0);
+    for (size_t i = 1; i <= owner.size(); i++)
+        tree[i] = 1;
+    for (size_t i = 1; i <= capacity; i++) {
+        size_t parent = i + (i & (~i + 1));
+        if (parent <= capacity)
+            tree[parent] += tree[i];
+    }
+}
+
+size_t ReuseStack::touch(uint32_t& slot) {
+    size_t distance = COLD;
+
+    if (slot != NONE) {
+        distance = live - prefix(slot);
+        add(slot, -1);
+        owner[slot] = nullptr;
+        live--;
+    }
+
+    // out of slots: compact, growing so at least half the tree is free
+    if (owner.size() + 1 >= tree.size())
+        rebuild(std::max<size_t>(64, 2 * (live + 1)));
+
+    slot = static_cast<uint32_t>(owner.size());
+    owner.push_back(&slot);
+    add(slot, 1);
+    live++;
+
+    return distance;
+}
+
+size_t ReuseStack::distinct() const {
+    return live;
+}
+
+// ================= Profiler =================
+StackDistanceProfiler::StackDistanceProfiler() {
+    reset(32);
+}
+
+void StackDistanceProfiler::reset(size_t blockSize) {
+    this->blockSize = blockSize ? blockSize : 1;
+    accesses = 0;
+    coldMisses = 0;
+
+    lines.clear();
+    full.reset();
+    fullHistogram.clear();
+
+    setCounts.clear();
+    for (size_t sets = 2; sets <= MAX_SETS; sets *= 2) {
+        SetCount sc;
+        sc.sets = sets;
+        sc.stacks.resize(sets);
+        sc.histogram.assign(MAX_WAYS, 0);
+        setCounts.push_back(std::move(sc));
+    }
+}
+
+void StackDistanceProfiler::access(size_t addr) {
+    size_t line = addr / blockSize;
+    accesses++;
+
+    auto found = lines.find(line);
+    if (found == lines.end()) {
+        LineSlots fresh;
+        fresh.full = ReuseStack::NONE;
+        for (uint32_t& slot : fresh.bySets)
+            slot = ReuseStack::NONE;
+        found = lines.emplace(line, fresh).first;
+    }
+    LineSlots& slots = found->second;
+
+    size_t distance = full.touch(slots.full);
+    if (distance == ReuseStack::COLD) {
+        coldMisses++;
+    }
+    else {
+        if (distance >= fullHistogram.size())
+            fullHistogram.resize(distance + 1, 0);
+        fullHistogram[distance]++;
+    }
+
+    // the first touch of a line is cold for every set count too, and
+    // COLD is past every bucket, so it needs no special case here
+    for (size_t i = 0; i < SET_COUNTS; i++) {
+        SetCount& sc = setCounts[i];
+        size_t d = sc.stacks[line & (sc.sets - 1)].touch(slots.bySets[i]);
+        if (d < MAX_WAYS)
+            sc.histogram[d]++;
+    }
+}
+
+uint64_t StackDistanceProfiler::hits(size_t sets, size_t ways) const {
+    const std::vector<uint64_t>* histogram = &fullHistogram;
+    if (sets > 1) {
+        histogram = nullptr;
+        for (const SetCount& sc : setCounts) {
+            if (sc.sets == sets)
+                histogram = &sc.histogram;
+        }
+        if (!histogram)
+            return 0;
+    }
+
+    uint64_t total = 0;
+    size_t limit = std::min(ways, histogram->size());
+    for (size_t d = 0; d < limit; d++)
+        total += (*histogram)[d];
+    return total;
+}
+
+uint64_t StackDistanceProfiler::getAccesses() const {
+    return accesses;
+}
+
+uint64_t StackDistanceProfiler::getColdMisses() const {
+    return coldMisses;
+}
+
+size_t StackDistanceProfiler::getDistinctLines() const {
+    return full.distinct();
+}
+
+size_t StackDistanceProfiler::getBlockSize() const {
+    return blockSize;
+}
+
+// ================= Reporting =================
+static double hitRate(uint64_t hits, uint64_t accesses) {
+    return accesses == 0 ? 0.0 : (double)hits / accesses * 100.0;
+}
+
+void StackDistanceProfiler::printCurve() const {
+    std::cout << std::dec;
+    std::cout << "=== LRU Hit-Rate Curve ===\n";
+    std::cout << "Block size     : " << blockSize << " bytes\n";
+    std::cout << "Accesses       : " << accesses << "\n";
+    std::cout << "Distinct lines : " << full.distinct() << "\n";
+    std::cout << "Cold misses    : " << coldMisses << "\n";
+
+    // fully associative: powers of two until every reuse hits
+    std::cout << "\nFully associative\n";
+    std::cout << "Lines\tBytes\tHit Rate\n";
+    size_t maxLines = std::max<size_t>(1, fullHistogram.size());
+    for (size_t lines = 1; ; lines *= 2) {
+        std::cout << lines << "\t" << lines * blockSize << "\t"
+                  << hitRate(hits(1, lines), accesses) << "%\n";
+        if (lines >= maxLines)
+            break;
+    }
+
+    std::cout << "\nSet associative (hit rate %, rows = sets, columns = ways)\n";
+    std::cout << "Sets";
+    for (size_t ways = 1; ways <= MAX_WAYS; ways *= 2)
+        std::cout << "\t" << ways;
+    std::cout << "\n";
+
+    for (const SetCount& sc : setCounts) {
+        std::cout << sc.sets;
+        for (size_t ways = 1; ways <= MAX_WAYS; ways *= 2)
+            std::cout << "\t" << hitRate(hits(sc.sets, ways), accesses);
+        std::cout << "\n";
+    }
+}
+
+bool StackDistanceProfiler::writeCsv(const std::string& path) const {
+    std::ofstream out(path);
+    if (!out) {
+        std::cout << "Error: cannot write " << path << "\n";
+        return false;
+    }
+
+    out << "sets,ways,lines,bytes,hits,hit_rate\n";
+
+    auto row = [&](size_t sets, size_t ways) {
+        uint64_t h = hits(sets, ways);
+        out << sets << "," << ways << "," << sets * ways << ","
+            << sets * ways * blockSize << "," << h << ","
+            << hitRate(h, accesses) << "\n";
+    };
+
+    size_t maxLines = std::max<size_t>(1, fullHistogram.size());
+    for (size_t lines = 1; ; lines *= 2) {
+        row(1, lines);
+        if (lines >= maxLines)
+            break;
+    }
+    for (const SetCount& sc : setCounts) {
+        for (size_t ways = 1; ways <= MAX_WAYS; ways *= 2)
+            row(sc.sets, ways);
+    }
+    return true;
+}
@@ -0,0 +1,402 @@
+#include "../include/event_sink.h"
+#include <charconv>
+#include <cstring>
+#include <iostream>
+
+EventSink& defaultSink() {
+    static TextSink sink(std::cout, 0);
+    return sink;
+}
+
+// ================= Text =================
+TextSink::TextSink(std::ostream& stream, size_t bytes)
+    : out(stream),
+      flushBytes(bytes)
+{
+    buffer.reserve(flushBytes + 256);
+}
+
+TextSink::~TextSink() {
+    flush();
+}
+
+// ---------- Formatting ----------
+void TextSink::put(const char* text) {
+    buffer += text;
+}
+
+void TextSink::putDec(size_t value) {
+    char digits[24];
+    char* end = std::to_chars(digits, digits + sizeof(digits), value).ptr;
+    buffer.append(digits, end);
+}
+
+void TextSink::putHex(size_t value) {
+    char digits[24];
+    char* end = std::to_chars(digits, digits + sizeof(digits), value, 16).ptr;
+    buffer.append(digits, end);
+}
+
+void TextSink::endLine() {
+    buffer += '\n';
+    if (buffer.size() >= flushBytes)
+        flush();
+}
+
+void TextSink::flush() {
+    if (buffer.empty())
+        return;
+    out.write(buffer.data(), buffer.size());
+    buffer.clear();
+}
+
+// ---------- Events ----------
+void TextSink::initialized(EventSource source, size_t bytes,
+                           size_t slabSize) {
+    if (source == EventSource::MEMORY)
+        put("Memory initialized: ");
+    else if (source == EventSource::BUDDY)
+        put("Buddy memory initialized: ");
+    else
+        put("Slab memory initialized: ");
+    putDec(bytes);
+    put(" bytes");
+    if (source == EventSource::SLAB) {
+        put(" (slab size ");
+        putDec(slabSize);
+        put(")");
+    }
+    endLine();
+}
+
+void TextSink::allocatorSet() {
+    put("Allocator set");
+    endLine();
+}
+
+void TextSink::allocated(EventSource source, int id, size_t addr,
+                         size_t size) {
+    put("Allocated block id=");
+    putDec(id);
+    put(" at address=0x");
+    putHex(addr);
+    // Memory has always left the size out
+    if (source != EventSource::MEMORY) {
+        put(" size=");
+        putDec(size);
+    }
+    endLine();
+}
+
+void TextSink::allocationFailed(EventSource, size_t) {
+    put("Allocation failed");
+    endLine();
+}
+
+void TextSink::freed(EventSource, int id, FreeKind kind) {
+    put("Block ");
+    putDec(id);
+    if (kind == FreeKind::MERGED)
+        put(" freed and merged");
+    else if (kind == FreeKind::DEFERRED)
+        put(" freed (merge deferred)");
+    else
+        put(" freed");
+    endLine();
+}
+
+void TextSink::invalidFree(EventSource, int) {
+    put("Invalid block id");
+    endLine();
+}
+
+void TextSink::accessed(const AccessEvent& event) {
+    put(event.write ? "Write 0x" : "Read 0x");
+    putHex(event.addr);
+
+    if (event.outside) {
+        put(": outside the virtual address space");
+        endLine();
+        return;
+    }
+    if (event.translated) {
+        put(" -> 0x");
+        putHex(event.phys);
+        if (event.fault)
+            put(" (page fault)");
+    }
+
+    put(": ");
+    if (event.level < 0) {
+        put("memory");
+    } else {
+        put(event.levelName);
+        put(" hit");
+    }
+    endLine();
+}
+
+// ================= Counters =================
+CountingSink::CountingSink()
+    : counts{0, 0, 0, 0, 0, 0, 0, 0, 0, 0}
+{
+}
+
+void CountingSink::accessed(const AccessEvent& event) {
+    if (event.write)
+        counts.writes++;
+    else
+        counts.reads++;
+
+    if (event.outside) {
+        counts.outside++;
+        return;
+    }
+    if (event.fault)
+        counts.pageFaults++;
+    if (event.level < 0)
+        counts.memoryAccesses++;
+    else
+        counts.cacheHits++;
+}
+
+const EventCounts& CountingSink::getCounts() const {
+    return counts;
+}
+
+void CountingSink::report(std::ostream& out) const {
+    out << "Event Counts\n";
+    out << "Allocations   : " << counts.allocations << " ("
+        << counts.allocationFailures << " failed)\n";
+    out << "Frees         : " << counts.frees << " ("
+        << counts.invalidFrees << " invalid)\n";
+    out << "Reads         : " << counts.reads << "\n";
+    out << "Writes        : " << counts.writes << "\n";
+    out << "Cache hits    : " << counts.cacheHits << "\n";
+    out << "Memory        : " << counts.memoryAccesses << "\n";
+    out << "Page faults   : " << counts.pageFaults << "\n";
+    if (counts.outside > 0)
+        out << "Outside VA    : " << counts.outside << "\n";
+}
+
+// ================= JSON =================
+static const char* sourceName(EventSource source) {
+    switch (source) {
+    case EventSource::MEMORY:   return "memory";
+    case EventSource::BUDDY:    return "buddy";
+    case EventSource::SLAB:     return "slab";
+    }
+    return "?";
+}
+
+// appends text as a JSON string
+static void appendQuoted(std::string& out, const char* text, size_t length) {
+    static const char HEX[] = "0123456789abcdef";
+    out += '"';
+    for (size_t i = 0; i < length; i++) {
+        unsigned char c = static_cast<unsigned char>(text[i]);
+        if (c == '"' || c == '\\') {
+            out += '\\';
+            out += static_cast<char>(c);
+        } else if (c < 0x20) {
+            out += "\\u00";
+            out += HEX[c >> 4];
+            out += HEX[c & 15];
+        } else {
+            out += static_cast<char>(c);
+        }
+    }
+    out += '"';
+}
+
+JsonSink::JsonSink(std::ostream& stream)
+    : captured(stream),
+      real(stream.rdbuf(text.rdbuf()))
+{
+}
+
+JsonSink::~JsonSink() {
+    flush();
+    captured.rdbuf(real);
+}
+
+// ---------- Formatting ----------
+void JsonSink::begin(const char* event) {
+    drainText();
+    buffer += "{\"event\":\"";
+    buffer += event;
+    buffer += '"';
+}
+
+void JsonSink::field(const char* name, size_t value) {
+    char digits[24];
+    char* end = std::to_chars(digits, digits + sizeof(digits), value).ptr;
+    buffer += ",\"";
+    buffer += name;
+    buffer += "\":";
+    buffer.append(digits, end);
+}
+
+void JsonSink::field(const char* name, bool value) {
+    buffer += ",\"";
+    buffer += name;
+    buffer += value ? "\":true" : "\":false";
+}
+
+void JsonSink::field(const char* name, const char* value) {
+    buffer += ",\"";
+    buffer += name;
+    buffer += "\":";
+    appendQuoted(buffer, value, std::strlen(value));
+}
+
+void JsonSink::end() {
+    buffer += "}\n";
+    if (buffer.size() >= TextSink::BATCH_BYTES)
+        flush();
+}
+
+// every complete line printed to the captured stream, as text events
+void JsonSink::drainText() {
+    std::string pending = text.str();
+    if (pending.empty())
+        return;
+
+    size_t start = 0;
+    size_t newline;
+    while ((newline = pending.find('\n', start)) != std::string::npos) {
+        buffer += "{\"event\":\"text\",\"text\":";
+        appendQuoted(buffer, pending.data() + start, newline - start);
+        buffer += "}\n";
+        start = newline + 1;
+    }
+    text.str(pending.substr(start));
+    text.seekp(0, std::ios::end);
+}
+
+void JsonSink::flush() {
+    drainText();
+    if (!buffer.empty()) {
+        real->sputn(buffer.data(), buffer.size());
+        buffer.clear();
+    }
+    real->pubsync();
+}
+
+void JsonSink::ready() {
+    // a last line without its newline belongs to this command too
+    if (!text.str().empty())
+        text << '\n';
+    begin("ready");
+    end();
+    flush();
+}
+
+// ---------- Events ----------
+void JsonSink::initialized(EventSource source, size_t bytes,
+                           size_t slabSize) {
+    begin("init");
+    field("source", sourceName(source));
+    field("size", bytes);
+    if (source == EventSource::SLAB)
+        field("slab_size", slabSize);
+    end();
+}
+
+void JsonSink::allocatorSet() {
+    begin("allocator_set");
+    end();
+}
+
+void JsonSink::allocated(EventSource source, int id, size_t addr,
+                         size_t size) {
+    begin("alloc");
+    field("source", sourceName(source));
+    field("id", static_cast<size_t>(id));
+    field("addr", addr);
+    field("size", size);
+    end();
+}
+
+void JsonSink::allocationFailed(EventSource source, size_t size) {
+    begin("alloc_failed");
+    field("source", sourceName(source));
+    field("size", size);
+    end();
+}
+
+void JsonSink::freed(EventSource source, int id, FreeKind kind) {
+    begin("free");
+    field("source", sourceName(source));
+    field("id", static_cast<size_t>(id));
+    field("kind", kind == FreeKind::MERGED   ? "merged"
+                : kind == FreeKind::DEFERRED ? "deferred"
+                :                              "returned");
+    end();
+}
+
+void JsonSink::invalidFree(EventSource source, int id) {
+    // ids come from the command line and may be negative
+    begin("invalid_free");
+    field("source", sourceName(source));
+    buffer += ",\"id\":";
+    buffer += std::to_string(id);
+    end();
+}
+
+void JsonSink::accessed(const AccessEvent& event) {
+    begin("access");
+    field("addr", event.addr);
+    field("write", event.write);
+    if (event.outside) {
+        field("outside", true);
+        end();
+        return;
+    }
+    if (event.translated) {
+        field("phys", event.phys);
+        field("fault", event.fault);
+    }
+    if (event.level < 0)
+        buffer += ",\"level\":null";
+    else
+        field("level", event.levelName);
+    end();
+}
+
+void JsonSink::split(EventSource source, size_t addr, size_t size,
+                     size_t rest) {
+    begin("split");
+    field("source", sourceName(source));
+    field("addr", addr);
+    field("size", size);
+    field("rest", rest);
+    end();
+}
+
+void JsonSink::merged(EventSource source, size_t addr, size_t size) {
+    begin("merge");
+    field("source", sourceName(source));
+    field("addr", addr);
+    field("size", size);
+    end();
+}
+
+void JsonSink::cacheFilled(const std::string& level, size_t addr,
+                           bool prefetched) {
+    begin("fill");
+    field("level", level.c_str());
+    field("addr", addr);
+    if (prefetched)
+        field("prefetch", true);
+    end();
+}
+
+void JsonSink::cacheEvicted(const std::string& level, size_t addr,
+                            bool dirty) {
+    begin("evict");
+    field("level", level.c_str());
+    field("addr", addr);
+    field("dirty", dirty);
+    end();
+}
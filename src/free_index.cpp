@@ -0,0 +1,148 @@
+#include "../include/free_index.h"
+#include "../include/memory.h"
+#include <algorithm>
+
+// ---------- Constructor ----------
+FreeIndex::FreeIndex()
+    : root(-1),
+      seed(2463534242u) {}
+
+void FreeIndex::clear() {
+    bySize.clear();
+    nodes.clear();
+    spareNodes.clear();
+    root = -1;
+}
+
+size_t FreeIndex::size() const {
+    return bySize.size();
+}
+
+bool FreeIndex::BySize::operator()(const Block* a, const Block* b) const {
+    if (a->size != b->size)
+        return a->size < b->size;
+    return a->start < b->start;
+}
+
+// ---------- Treap helpers ----------
+uint32_t FreeIndex::nextPriority() {
+    // xorshift32, deterministic so runs are reproducible
+    seed ^= seed << 13;
+    seed ^= seed >> 17;
+    seed ^= seed << 5;
+    return seed;
+}
+
+int FreeIndex::newNode(Block* block) {
+    int id;
+    if (!spareNodes.empty()) {
+        id = spareNodes.back();
+        spareNodes.pop_back();
+    } else {
+        id = static_cast<int>(nodes.size());
+        nodes.push_back({});
+    }
+
+    nodes[id] = {block, -1, -1, nextPriority(), block->size};
+    return id;
+}
+
+void FreeIndex::pull(int t) {
+    Node& n = nodes[t];
+    n.maxSize = n.block->size;
+    if (n.left != -1)
+        n.maxSize = std::max(n.maxSize, nodes[n.left].maxSize);
+    if (n.right != -1)
+        n.maxSize = std::max(n.maxSize, nodes[n.right].maxSize);
+}
+
+// left: blocks starting before `start`, right: the rest
+void FreeIndex::split(int t, size_t start, int& left, int& right) {
+    if (t == -1) {
+        left = right = -1;
+        return;
+    }
+
+    if (nodes[t].block->start < start) {
+        split(nodes[t].right, start, nodes[t].right, right);
+        left = t;
+    } else {
+        split(nodes[t].left, start, left, nodes[t].left);
+        right = t;
+    }
+    pull(t);
+}
+
+int FreeIndex::merge(int left, int right) {
+    if (left == -1) return right;
+    if (right == -1) return left;
+
+    if (nodes[left].priority > nodes[right].priority) {
+        nodes[left].right = merge(nodes[left].right, right);
+        pull(left);
+        return left;
+    }
+
+    nodes[right].left = merge(left, nodes[right].left);
+    pull(right);
+    return right;
+}
+
+// ---------- Update ----------
+void FreeIndex::insert(Block* block) {
+    if (block->size == 0)
+        return;
+
+    bySize.insert(block);
+
+    int left, right;
+    split(root, block->start, left, right);
+    root = merge(merge(left, newNode(block)), right);
+}
+
+void FreeIndex::erase(Block* block) {
+    if (block->size == 0)
+        return;
+
+    bySize.erase(block);
+
+    int left, mid, right;
+    split(root, block->start, left, right);
+    split(right, block->start + 1, mid, right);
+
+    if (mid != -1)
+        spareNodes.push_back(mid);
+
+    root = merge(left, right);
+}
+
+// ---------- Queries ----------
+Block* FreeIndex::firstFit(size_t size) const {
+    if (root == -1 || nodes[root].maxSize < size)
+        return nullptr;
+
+    int t = root;
+    while (true) {
+        const Node& n = nodes[t];
+        if (n.left != -1 && nodes[n.left].maxSize >= size)
+            t = n.left;
+        else if (n.block->size >= size)
+            return n.block;
+        else
+            t = n.right;
+    }
+}
+
+Block* FreeIndex::bestFit(size_t size) const {
+    Block probe{0, size, true, -1, nullptr, nullptr, nullptr, nullptr};
+    auto it = bySize.lower_bound(&probe);
+    return it == bySize.end() ? nullptr : *it;
+}
+
+Block* FreeIndex::worstFit(size_t size) const {
+    if (root == -1 || nodes[root].maxSize < size)
+        return nullptr;
+
+    // first block in address order whose size equals the maximum
+    return firstFit(nodes[root].maxSize);
+}
@@ -1,64 +1,650 @@
 #include "../include/memory.h"
-#include "../include/cache/cache.h"
+#include "../include/event_sink.h"
+#include "../include/cache/hierarchy.h"
 #include "../include/buddy/buddy.h"
+#include "../include/slab/slab.h"
+#include "../include/multicore/multicore.h"
+#include "../include/virtual_memory/vm.h"
+#include "../include/trace/trace.h"
+#include "../include/trace/stream.h"
+#include "../include/workload/generator.h"
 
+#include <chrono>
 #include <iostream>
+#include <memory>
 #include <sstream>
 #include <string>
+#include <vector>
 
 // ---------- helper ----------
 bool isPowerOfTwo(size_t x) {
     return x && !(x & (x - 1));
 }
 
-int main() {
+// decimal or 0x-prefixed hex
+bool parseAddress(const std::string& text, size_t& addr) {
+    std::stringstream parse(text);
+    if (text.compare(0, 2, "0x") == 0 || text.compare(0, 2, "0X") == 0)
+        parse.ignore(2) >> std::hex;
+    return static_cast<bool>(parse >> addr);
+}
+
+// bytes with an optional k / m / g suffix ("2m", "1G", "4096")
+bool parseSize(const std::string& text, size_t& bytes) {
+    std::stringstream parse(text);
+    std::string suffix;
+    if (!(parse >> bytes))
+        return false;
+    parse >> suffix;
+    if (suffix == "k" || suffix == "K")         bytes <<= 10;
+    else if (suffix == "m" || suffix == "M")    bytes <<= 20;
+    else if (suffix == "g" || suffix == "G")    bytes <<= 30;
+    else if (!suffix.empty())                   return false;
+    return true;
+}
+
+// which allocator the commands go to
+enum class Mode {
+    MEMORY,
+    BUDDY,
+    SLAB
+};
+
+// everything the commands act on
+struct Simulator {
     Memory mem;
     BuddyAllocator buddy;
+    SlabAllocator slab;
 
-    bool useBuddy = false;
+    Mode mode;
 
-    // L1 Cache: 8 sets, 2-way, block size 32 bytes, LRU
-    Cache l1(8, 2, 32, "LRU", "L1");
+    // off until "init vm"; then read / write take virtual addresses
+    VirtualMemory vm;
+
+    CacheHierarchy caches;
+
+    // where the allocators and read / write report to
+    EventSink* sink;
 
+    Simulator();
+    void setSink(EventSink* eventSink);
+};
+
+Simulator::Simulator()
+    : mode(Mode::MEMORY),
+      sink(&defaultSink())
+{
+    // DTLB: 16 sets, 4-way (64 entries); STLB: 128 sets, 12-way (1536)
+    vm.addTlbLevel({"DTLB", 16, 4, "LRU", 1});
+    vm.addTlbLevel({"STLB", 128, 12, "LRU", 1});
+
+    // Default hierarchy, replaceable with "cache load" / "cache add"
+    // L1 Cache: 8 sets, 2-way, block size 32 bytes, LRU
+    caches.addLevel({"L1", 8, 2, 32, "LRU", 1});
     // L2 Cache: 16 sets, 4-way, block size 32 bytes, FIFO
-    Cache l2(16, 4, 32, "FIFO", "L2");
+    caches.addLevel({"L2", 16, 4, 32, "FIFO", 1});
+}
+
+void Simulator::setSink(EventSink* eventSink) {
+    sink = eventSink;
+    mem.setSink(eventSink);
+    buddy.setSink(eventSink);
+    slab.setSink(eventSink);
+}
+
+// ================= Shared Operations =================
+// Commands that both the interactive loop and trace replay run, so the
+// two produce the same output.
+
+// init memory / buddy / slab <size>, init vm <size> <physSize>; false
+// for an unknown type
+bool initTarget(Simulator& sim, const std::string& type,
+                size_t size, size_t physSize) {
+    if (type == "memory") {
+        sim.mem.init(size);
+        sim.mode = Mode::MEMORY;
+        sim.caches.reset();
+    }
+    else if (type == "buddy") {
+        if (!isPowerOfTwo(size)) {
+            std::cout
+                << "Error: Buddy allocator requires size to be power of two\n";
+            return true;
+        }
+        if (size > BuddyAllocator::MAX_SIZE) {
+            std::cout << "Error: Buddy allocator size is limited to "
+                      << BuddyAllocator::MAX_SIZE << " bytes\n";
+            return true;
+        }
+        sim.buddy.init(size);
+        sim.mode = Mode::BUDDY;
+        sim.caches.reset();
+    }
+    else if (type == "slab") {
+        if (!isPowerOfTwo(size)) {
+            std::cout
+                << "Error: Slab allocator requires size to be power of two\n";
+            return true;
+        }
+        if (size > BuddyAllocator::MAX_SIZE) {
+            std::cout << "Error: Slab allocator size is limited to "
+                      << BuddyAllocator::MAX_SIZE << " bytes\n";
+            return true;
+        }
+        sim.slab.init(size);
+        sim.mode = Mode::SLAB;
+        sim.caches.reset();
+    }
+    else if (type == "vm") {
+        if (sim.vm.init(size, physSize)) {
+            std::cout << "Virtual memory initialized: page size "
+                      << size << ", " << physSize / size
+                      << " frames, "
+                      << sim.vm.getPageTable().getLevels()
+                      << "-level page table\n";
+            sim.caches.reset();
+        }
+    }
+    else {
+        return false;
+    }
+    return true;
+}
+
+// returns the new block's id, or -1 if the allocation failed
+int mallocOp(Simulator& sim, size_t size) {
+    if (sim.mode == Mode::BUDDY)
+        return sim.buddy.mallocBlock(size);
+    if (sim.mode == Mode::SLAB)
+        return sim.slab.mallocBlock(size);
+
+    int id;
+    size_t addr = sim.mem.mallocBlock(size, id);
+    if (addr != static_cast<size_t>(-1)) {
+        // ---------- Cache hierarchy ----------
+        sim.caches.access(addr);
+    }
+    return id;
+}
+
+void freeOp(Simulator& sim, int id) {
+    if (sim.mode == Mode::BUDDY) {
+        sim.buddy.freeBlock(id);
+    }
+    else if (sim.mode == Mode::SLAB) {
+        sim.slab.freeBlock(id);
+    }
+    else {
+        sim.mem.freeBlock(id);
+        // No cache access on free
+    }
+}
+
+void accessOp(Simulator& sim, size_t addr, bool write) {
+    AccessEvent event{addr, write, false, false, addr, false, -1, ""};
+
+    // with virtual memory on, the caches see the physical address
+    if (sim.vm.isInitialized()) {
+        TranslateInfo info;
+        event.translated = true;
+        event.phys = sim.vm.translate(addr, write, info);
+        if (event.phys == VirtualMemory::INVALID) {
+            event.outside = true;
+            sim.sink->accessed(event);
+            return;
+        }
+        event.fault = info.fault;
+    }
+
+    event.level = sim.caches.access(event.phys, write);
+    if (event.level >= 0)
+        event.levelName = sim.caches.level(event.level).getName().c_str();
+    sim.sink->accessed(event);
+}
+
+// malloc / free / read / write only report through the sink; anything
+// else may print directly, so a buffering sink is flushed first
+bool isEventOnly(const std::string& cmd) {
+    return cmd == "malloc" || cmd == "free" ||
+           cmd == "read" || cmd == "write";
+}
+
+// ================= Trace Replay =================
+// runs one trace record as the command it stands for
+void applyRecord(Simulator& sim, const TraceRecord& record) {
+    // init and set allocator may print directly
+    if (record.op < TraceOp::MALLOC)
+        sim.sink->flush();
+
+    switch (record.op) {
+    case TraceOp::INIT_MEMORY:
+        initTarget(sim, "memory", record.arg, 0);
+        break;
+    case TraceOp::INIT_BUDDY:
+        initTarget(sim, "buddy", record.arg, 0);
+        break;
+    case TraceOp::INIT_SLAB:
+        initTarget(sim, "slab", record.arg, 0);
+        break;
+    case TraceOp::INIT_VM:
+        initTarget(sim, "vm", static_cast<size_t>(1) << (record.arg & 63),
+                   static_cast<size_t>(1) << ((record.arg >> 8) & 63));
+        break;
+    case TraceOp::SET_ALLOCATOR:
+        if (sim.mode == Mode::MEMORY)
+            sim.mem.setAllocator(static_cast<AllocatorType>(record.arg));
+        else if (sim.mode == Mode::BUDDY)
+            std::cout << "Allocator setting ignored in Buddy mode\n";
+        else
+            std::cout << "Allocator setting ignored in Slab mode\n";
+        break;
+    case TraceOp::MALLOC:
+        mallocOp(sim, record.arg);
+        break;
+    case TraceOp::FREE:
+        freeOp(sim, static_cast<int>(record.arg));
+        break;
+    case TraceOp::READ:
+        accessOp(sim, record.arg, false);
+        break;
+    case TraceOp::WRITE:
+        accessOp(sim, record.arg, true);
+        break;
+    }
+}
+
+// prints how many records of each kind a run applied
+void printOpCounts(const size_t counts[16]) {
+    for (size_t op = 1; op < 16; op++) {
+        if (counts[op] > 0)
+            std::cout << "  " << traceOpName(static_cast<TraceOp>(op))
+                      << ": " << counts[op] << "\n";
+    }
+}
+
+// Runs a binary trace (trace.h) straight from the mapped file: no prompt
+// and no text parsing, with the same effects and output as the commands
+// it was converted from.
+bool replay(Simulator& sim, const std::string& path) {
+    TraceReader reader;
+    if (!reader.open(path))
+        return false;
+
+    size_t counts[16] = {};
+    size_t total = 0;
+    auto start = std::chrono::steady_clock::now();
+
+    TraceRecord record;
+    while (reader.next(record)) {
+        applyRecord(sim, record);
+        counts[static_cast<size_t>(record.op)]++;
+        total++;
+    }
+
+    double seconds = std::chrono::duration<double>(
+        std::chrono::steady_clock::now() - start).count();
+    sim.sink->flush();
+
+    if (reader.isCorrupt())
+        std::cout << "Error: " << path << " is truncated or corrupt after "
+                  << total << " records\n";
+    else if (total != reader.getRecords())
+        std::cout << "Warning: header of " << path << " promises "
+                  << reader.getRecords() << " records\n";
+
+    std::cout << "Replayed " << total << " records in " << seconds * 1e3
+              << " ms (" << (seconds > 0 ? total / seconds : 0.0)
+              << " ops/s)\n";
+    printOpCounts(counts);
+    return !reader.isCorrupt();
+}
+
+// ================= Streamed Traces =================
+// Feeds an external access trace (stream.h) through the VM and the cache
+// hierarchy batch by batch while the producer thread reads ahead. Only
+// the summary is printed: the per-access lines of read / write would
+// cost more than the simulation.
+//
+// Without the VM, accesses are gathered into chunks and handed to
+// CacheHierarchy::accessBatch, which replays a single plain cache level
+// on `threads` threads (0: one per hardware thread).
+bool streamTrace(Simulator& sim, const std::string& path, size_t threads) {
+    // accesses per accessBatch call: enough for every worker to have a
+    // large share
+    static const size_t CHUNK = 1 << 20;
+
+    TraceStream stream;
+    if (!stream.open(path))
+        return false;
+
+    bool translate = sim.vm.isInitialized();
+    size_t outside = 0;
+    std::vector<size_t> addrs;
+    std::vector<uint8_t> writes;
+    if (!translate) {
+        addrs.reserve(CHUNK);
+        writes.reserve(CHUNK);
+    }
+    auto start = std::chrono::steady_clock::now();
+
+    const TraceAccess* items;
+    size_t count;
+    while (stream.next(items, count)) {
+        if (!translate) {
+            for (size_t i = 0; i < count; i++) {
+                addrs.push_back(items[i].addr);
+                writes.push_back(items[i].write);
+            }
+            if (addrs.size() >= CHUNK) {
+                sim.caches.accessBatch(addrs.data(), writes.data(),
+                                       addrs.size(), threads);
+                addrs.clear();
+                writes.clear();
+            }
+            continue;
+        }
+
+        for (size_t i = 0; i < count; i++) {
+            TranslateInfo info;
+            size_t addr = sim.vm.translate(items[i].addr, items[i].write,
+                                           info);
+            if (addr == VirtualMemory::INVALID) {
+                outside++;
+                continue;
+            }
+            sim.caches.access(addr, items[i].write);
+        }
+    }
+    sim.caches.accessBatch(addrs.data(), writes.data(), addrs.size(),
+                           threads);
+    bool ok = stream.finish();
+
+    double seconds = std::chrono::duration<double>(
+        std::chrono::steady_clock::now() - start).count();
+    const StreamStats& stats = stream.getStats();
+
+    std::cout << "Streamed " << stats.accesses << " accesses ("
+              << stats.reads << " reads, " << stats.writes << " writes) in "
+              << seconds * 1e3 << " ms ("
+              << (seconds > 0 ? stats.accesses / seconds : 0.0)
+              << " accesses/s)\n";
+    std::cout << "  Lines: " << stats.lines << " (" << stats.instructions
+              << " instruction fetches skipped, " << stats.ignored
+              << " ignored, " << stats.malformed << " malformed)\n";
+    if (outside > 0)
+        std::cout << "  Outside the virtual address space: " << outside
+                  << "\n";
+    return ok;
+}
+
+// ================= Synthetic Workloads =================
+// gen [options]: reads the generator options (generator.h) from the
+// command line; false (with a message) on a bad option
+bool parseWorkload(int argc, char** argv, int arg, WorkloadConfig& config,
+                   std::string& output, TraceEncoding& encoding) {
+    for (; arg < argc; arg++) {
+        std::string option = argv[arg];
+        if (option == "--delta") {
+            encoding = TraceEncoding::DELTA;
+            continue;
+        }
+        if (arg + 1 == argc) {
+            std::cout << "Error: " << option << " needs a value\n";
+            return false;
+        }
+        std::string value = argv[++arg];
+        std::stringstream parse(value);
+        bool ok = true;
+
+        if (option == "-o") {
+            output = value;
+        }
+        else if (option == "--seed")            ok = !!(parse >> config.seed);
+        else if (option == "--ops")             ok = !!(parse >> config.ops);
+        else if (option == "--heap")            ok = parseSize(value, config.heapSize);
+        else if (option == "--min")             ok = parseSize(value, config.minSize);
+        else if (option == "--max")             ok = parseSize(value, config.maxSize);
+        else if (option == "--alpha")           ok = !!(parse >> config.alpha);
+        else if (option == "--large")           ok = !!(parse >> config.largeFraction);
+        else if (option == "--live")            ok = !!(parse >> config.liveTarget);
+        else if (option == "--long-lived")      ok = !!(parse >> config.longLivedFraction);
+        else if (option == "--access-ratio")    ok = !!(parse >> config.accessRatio);
+        else if (option == "--write-ratio")     ok = !!(parse >> config.writeRatio);
+        else if (option == "--zipf")            ok = !!(parse >> config.zipf);
+        else if (option == "--footprint")       ok = parseSize(value, config.footprint);
+        else if (option == "--sizes")           ok = parseSizeDistribution(value, config.sizes);
+        else if (option == "--lifetime")        ok = parseLifetimeModel(value, config.lifetime);
+        else if (option == "--pattern")         ok = parseWorkloadPattern(value, config.pattern);
+        else if (option == "--allocator") {
+            config.init = TraceOp::INIT_MEMORY;
+            if (value == "first_fit")
+                config.allocator = AllocatorType::FIRST_FIT;
+            else if (value == "best_fit")
+                config.allocator = AllocatorType::BEST_FIT;
+            else if (value == "worst_fit")
+                config.allocator = AllocatorType::WORST_FIT;
+            else if (value == "tlsf")
+                config.allocator = AllocatorType::TLSF;
+            else if (value == "buddy")
+                config.init = TraceOp::INIT_BUDDY;
+            else if (value == "slab")
+                config.init = TraceOp::INIT_SLAB;
+            else
+                ok = false;
+        }
+        else {
+            std::cout << "Error: unknown gen option " << option << "\n";
+            return false;
+        }
+
+        if (!ok) {
+            std::cout << "Error: bad value for " << option << ": " << value
+                      << "\n";
+            return false;
+        }
+    }
+
+    if (config.init != TraceOp::INIT_MEMORY && !isPowerOfTwo(config.heapSize)) {
+        std::cout << "Error: buddy and slab heaps must be a power of two\n";
+        return false;
+    }
+    if (config.init != TraceOp::INIT_MEMORY &&
+        config.heapSize > BuddyAllocator::MAX_SIZE) {
+        std::cout << "Error: buddy and slab heaps are limited to "
+                  << BuddyAllocator::MAX_SIZE << " bytes\n";
+        return false;
+    }
+    if (config.heapSize == 0 || config.heapSize > TraceWriter::MAX_ARG ||
+        config.maxSize > TraceWriter::MAX_ARG) {
+        std::cout << "Error: heap size out of range\n";
+        return false;
+    }
+    return true;
+}
+
+// Runs a generated workload straight through the simulator, or writes it
+// to a binary trace for --replay when `output` is set. No file and no
+// text parsing on the direct path: the records go from the generator to
+// the allocator as they are drawn.
+//
+// The generator numbers blocks as if every malloc succeeded. The direct
+// path maps its ids to the ones the allocator handed out, and drops the
+// frees of blocks whose malloc failed. A trace cannot do that, so it
+// gets a warning when the live set outgrew the heap.
+bool runWorkload(Simulator& sim, const WorkloadConfig& config,
+                 const std::string& output, TraceEncoding encoding) {
+    WorkloadGenerator generator(config);
+    TraceRecord record;
+
+    if (!output.empty()) {
+        TraceWriter writer;
+        if (!writer.open(output, encoding))
+            return false;
+        while (generator.next(record))
+            writer.append(record.op, record.arg);
+        if (!writer.close()) {
+            std::cout << "Error: cannot write " << output << "\n";
+            return false;
+        }
+        std::cout << "Generated " << writer.getRecords() << " records to "
+                  << output << " (" << writer.getBytes() << " bytes, "
+                  << (encoding == TraceEncoding::DELTA ? "delta" : "fixed")
+                  << " encoding)\n";
+    }
+    else {
+        size_t counts[16] = {};
+        size_t total = 0;
+        std::vector<int> blockIds(1, -1);   // generator id -> simulator id
+        size_t orphanFrees = 0;
+        auto start = std::chrono::steady_clock::now();
+
+        while (generator.next(record)) {
+            if (record.op == TraceOp::MALLOC) {
+                blockIds.push_back(mallocOp(sim, record.arg));
+            } else if (record.op == TraceOp::FREE) {
+                int id = blockIds[record.arg];
+                if (id < 0)
+                    orphanFrees++;
+                else
+                    freeOp(sim, id);
+            } else {
+                applyRecord(sim, record);
+            }
+            counts[static_cast<size_t>(record.op)]++;
+            total++;
+        }
+
+        double seconds = std::chrono::duration<double>(
+            std::chrono::steady_clock::now() - start).count();
+        sim.sink->flush();
+
+        std::cout << "Generated " << total << " records in "
+                  << seconds * 1e3 << " ms ("
+                  << (seconds > 0 ? total / seconds : 0.0) << " ops/s)\n";
+        printOpCounts(counts);
+        if (orphanFrees > 0)
+            std::cout << "  Frees skipped (malloc failed): " << orphanFrees
+                      << "\n";
+    }
+
+    std::cout << "  Workload: seed " << config.seed << ", "
+              << sizeDistributionName(config.sizes) << " sizes, "
+              << lifetimeModelName(config.lifetime) << " lifetimes, "
+              << workloadPatternName(config.pattern) << "\n";
+    std::cout << "  Peak live: " << generator.getPeakLive() << " blocks, "
+              << generator.getPeakLiveBytes() << " bytes\n";
+    if (!output.empty() && generator.getPeakLiveBytes() > config.heapSize)
+        std::cout << "Warning: the live set outgrows the " << config.heapSize
+                  << "-byte heap; once a malloc fails, later frees in this "
+                     "trace name the wrong blocks\n";
+    return true;
+}
+
+// prints what a counting run saw and writes out buffered text
+void finishRun(Simulator& sim, const CountingSink& counting) {
+    if (sim.sink == &counting)
+        counting.report(std::cout);
+    sim.sink->flush();
+}
+
+int main(int argc, char** argv) {
+    Simulator sim;
+
+    // ---------- Command line ----------
+    // [--batch | --quiet | --counts | --json]
+    //     [--replay <trace> | --convert ... | gen ...]
+    TextSink batchSink(std::cout, TextSink::BATCH_BYTES);
+    NullSink nullSink;
+    CountingSink countingSink;
+    std::unique_ptr<JsonSink> jsonSink;
+    bool prompt = true;
+    int arg = 1;
+
+    if (arg < argc) {
+        std::string flag = argv[arg];
+        if (flag == "--json") {
+            // every line on stdout becomes JSON from here on
+            jsonSink.reset(new JsonSink(std::cout));
+            sim.caches.setSink(jsonSink.get());
+        }
+        EventSink* sink = flag == "--batch"  ? &batchSink
+                        : flag == "--quiet"  ? &nullSink
+                        : flag == "--counts" ? &countingSink
+                        : flag == "--json"   ? static_cast<EventSink*>(jsonSink.get())
+                        : nullptr;
+        if (sink) {
+            sim.setSink(sink);
+            prompt = false;
+            arg++;
+        }
+    }
+
+    if (arg < argc) {
+        std::string flag = argv[arg];
+        int rest = argc - arg;
+        if (flag == "--replay" && rest == 2) {
+            bool ok = replay(sim, argv[arg + 1]);
+            finishRun(sim, countingSink);
+            return ok ? 0 : 1;
+        }
+        if (flag == "gen") {
+            WorkloadConfig config;
+            std::string output;
+            TraceEncoding encoding = TraceEncoding::FIXED;
+            if (!parseWorkload(argc, argv, arg + 1, config, output, encoding))
+                return 1;
+            bool ok = runWorkload(sim, config, output, encoding);
+            finishRun(sim, countingSink);
+            return ok ? 0 : 1;
+        }
+        if (flag == "--convert" && (rest == 3 || (rest == 4 &&
+                                    std::string(argv[arg + 3]) == "--delta"))) {
+            TraceEncoding encoding = rest == 4 ? TraceEncoding::DELTA
+                                               : TraceEncoding::FIXED;
+            return convertScript(argv[arg + 1], argv[arg + 2], encoding) ? 0 : 1;
+        }
+        std::cout << "Usage: memsim [--batch | --quiet | --counts | --json]\n"
+                     "       memsim [--batch | --quiet | --counts | --json] --replay <trace.bin>\n"
+                     "       memsim --convert <script.txt> <trace.bin> [--delta]\n"
+                     "       memsim [--batch | --quiet | --counts | --json] gen [options] [-o <trace.bin> [--delta]]\n";
+        return 1;
+    }
+
+    Memory& mem = sim.mem;
+    BuddyAllocator& buddy = sim.buddy;
+    SlabAllocator& slab = sim.slab;
+    Mode& mode = sim.mode;
+    VirtualMemory& vm = sim.vm;
+    CacheHierarchy& caches = sim.caches;
 
     std::string line;
 
     while (true) {
-        std::cout << "> ";
-        std::getline(std::cin, line);
+        // JSON clients get a ready event instead of the prompt
+        if (jsonSink)
+            jsonSink->ready();
+        else if (prompt)
+            std::cout << "> ";
+        if (!std::getline(std::cin, line))
+            break;
 
         std::stringstream ss(line);
         std::string cmd;
         ss >> cmd;
 
+        if (!isEventOnly(cmd))
+            sim.sink->flush();
+
         // ---------- INIT ----------
         if (cmd == "init") {
             std::string type;
-            size_t size;
-            ss >> type >> size;
+            size_t size = 0;
+            size_t physSize = 0;
+            ss >> type >> size >> physSize;
 
-            if (type == "memory") {
-                mem.init(size);
-                useBuddy = false;
-                l1.reset();
-                l2.reset();
-            }
-            else if (type == "buddy") {
-                if (!isPowerOfTwo(size)) {
-                    std::cout
-                        << "Error: Buddy allocator requires size to be power of two\n";
-                    continue;
-                }
-                buddy.init(size);
-                useBuddy = true;
-                l1.reset();
-                l2.reset();
-            }
-            else {
+            if (!initTarget(sim, type, size, physSize)) {
                 std::cout
-                    << "Usage: init memory <size> | init buddy <size>\n";
+                    << "Usage: init memory <size> | init buddy <size> | init slab <size> | init vm <page_size> <phys_size>\n";
             }
         }
 
@@ -67,22 +653,90 @@ int main() {
             std::string sub, type;
             ss >> sub >> type;
 
-            if (!useBuddy && sub == "allocator") {
+            if (sub == "policy") {
+                // set policy <level> <name> [seed]
+                std::string name, seedText;
+                uint64_t seed = 1;
+                ss >> name >> seedText;
+                if (!seedText.empty())
+                    std::stringstream(seedText) >> seed;
+
+                ReplacementPolicy policy;
+                int level = caches.findLevel(type);
+                if (!parseReplacementPolicy(name, policy)) {
+                    std::cout << "Unknown replacement policy\n";
+                }
+                else if (level >= 0) {
+                    caches.setPolicy(level, name, seed);
+                    std::cout << caches.level(level).getName()
+                              << " replacement policy: "
+                              << replacementPolicyName(policy) << "\n";
+                }
+                else {
+                    std::cout
+                        << "Usage: set policy <l1|l2|...> <lru|fifo|plru|srrip|brrip|random|lfu> [seed]\n";
+                }
+            }
+            else if (sub == "paging") {
+                // set paging <fifo|lru|clock|wsclock> [tau]
+                PageReplacement policy;
+                size_t tau = vm.getTau();
+                ss >> tau;
+                if (!parsePageReplacement(type, policy)) {
+                    std::cout
+                        << "Usage: set paging <fifo|lru|clock|wsclock> [tau]\n";
+                    continue;
+                }
+                vm.setReplacement(policy, tau);
+                std::cout << "Page replacement: "
+                          << pageReplacementName(policy);
+                if (policy == PageReplacement::WSCLOCK)
+                    std::cout << " (tau " << tau << ")";
+                std::cout << "\n";
+            }
+            else if (sub == "hugepages") {
+                // set hugepages <off|fault|promote>
+                HugePageMode hugeMode;
+                if (!parseHugePageMode(type, hugeMode)) {
+                    std::cout
+                        << "Usage: set hugepages <off|fault|promote>\n";
+                    continue;
+                }
+                vm.setHugePages(hugeMode);
+                std::cout << "Huge pages: " << hugePageModeName(hugeMode)
+                          << "\n";
+            }
+            else if (mode == Mode::MEMORY && sub == "allocator") {
                 if (type == "first_fit")
                     mem.setAllocator(AllocatorType::FIRST_FIT);
                 else if (type == "best_fit")
                     mem.setAllocator(AllocatorType::BEST_FIT);
                 else if (type == "worst_fit")
                     mem.setAllocator(AllocatorType::WORST_FIT);
+                else if (type == "tlsf")
+                    mem.setAllocator(AllocatorType::TLSF);
                 else
                     std::cout << "Unknown allocator\n";
             }
-            else if (useBuddy) {
+            else if (mode == Mode::BUDDY && sub == "lazy") {
+                size_t watermark = 0;
+                std::stringstream(type) >> watermark;
+                buddy.setLazy(watermark);
+                if (watermark == 0)
+                    std::cout << "Lazy coalescing disabled\n";
+                else
+                    std::cout << "Lazy coalescing watermark: "
+                              << watermark << "\n";
+            }
+            else if (mode == Mode::BUDDY) {
                 std::cout << "Allocator setting ignored in Buddy mode\n";
             }
+            else if (mode == Mode::SLAB) {
+                std::cout << "Allocator setting ignored in Slab mode\n";
+            }
             else {
                 std::cout
-                    << "Usage: set allocator <first_fit|best_fit|worst_fit>\n";
+                    << "Usage: set allocator <first_fit|best_fit|worst_fit|tlsf>\n";
             }
         }
 
@@ -90,67 +744,402 @@ int main() {
         else if (cmd == "malloc") {
             size_t size;
             ss >> size;
-
-            if (useBuddy) {
-                buddy.mallocBlock(size);
-            }
-            else {
-                size_t addr = mem.mallocBlock(size);
-                if (addr != static_cast<size_t>(-1)) {
-
-                    // ---------- Cache hierarchy ----------
-                    if (!l1.access(addr)) {
-                        if (!l2.access(addr)) {
-                            // Miss in both → bring from memory
-                            // (already counted as misses)
-                        }
-                        // Fill L1 after L2 access
-                        l1.access(addr);
-                    }
-                }
-            }
+            mallocOp(sim, size);
         }
 
         // ---------- FREE ----------
         else if (cmd == "free") {
             int id;
             ss >> id;
-
-            if (useBuddy) {
-                buddy.freeBlock(id);
-            }
-            else {
-                mem.freeBlock(id);
-                // No cache access on free
-            }
+            freeOp(sim, id);
         }
 
         // ---------- DUMP ----------
         else if (cmd == "dump") {
-            if (useBuddy)
+            if (mode == Mode::BUDDY)
                 buddy.dump();
+            else if (mode == Mode::SLAB)
+                slab.dump();
             else
                 mem.dump();
         }
 
         // ---------- STATS ----------
         else if (cmd == "stats") {
-            if (useBuddy) {
-                std::cout << "Buddy Internal Fragmentation: "
-                          << buddy.getInternalFragmentation()
-                          << " bytes\n";
+            std::string sub;
+            ss >> sub;
+
+            if (sub == "vm") {
+                vm.stats();
+            }
+            else if (mode == Mode::BUDDY) {
+                buddy.stats();
+            }
+            else if (mode == Mode::SLAB) {
+                slab.stats();
             }
             else {
                 mem.stats();
             }
         }
 
+        // ---------- READ / WRITE ----------
+        else if (cmd == "read" || cmd == "write") {
+            std::string text;
+            ss >> text;
+
+            size_t addr = 0;
+            if (!parseAddress(text, addr)) {
+                sim.sink->flush();
+                std::cout << "Usage: " << cmd << " <address>\n";
+                continue;
+            }
+            accessOp(sim, addr, cmd == "write");
+        }
+
+        // ---------- TRANSLATE ----------
+        else if (cmd == "translate") {
+            std::string text;
+            ss >> text;
+
+            size_t addr = 0;
+            if (!parseAddress(text, addr)) {
+                std::cout << "Usage: translate <virtual address>\n";
+                continue;
+            }
+            if (!vm.isInitialized()) {
+                std::cout << "Error: virtual memory not initialized "
+                             "(init vm <page_size> <phys_size>)\n";
+                continue;
+            }
+
+            TranslateInfo info;
+            size_t phys = vm.translate(addr, false, info);
+            if (phys == VirtualMemory::INVALID) {
+                std::cout << "Error: address outside the 48-bit virtual "
+                             "address space\n";
+                continue;
+            }
+            std::cout << "Translate 0x" << std::hex << addr << " -> 0x"
+                      << phys << std::dec << " (";
+            if (info.fault)
+                std::cout << "page fault)\n";
+            else if (info.tlbLevel < 0)
+                std::cout << "page walk)\n";
+            else
+                std::cout << vm.tlbLevel(info.tlbLevel).getName()
+                          << " hit)\n";
+        }
+
+        // ---------- HUGE PAGES ----------
+        else if (cmd == "promote" || cmd == "demote") {
+            // promote <addr> [size] | demote <addr>
+            std::string text, sizeText;
+            ss >> text >> sizeText;
+
+            size_t addr = 0;
+            size_t bytes = vm.getPageSize() << PageTable::LEVEL_BITS;
+            if (!parseAddress(text, addr) ||
+                (!sizeText.empty() && !parseSize(sizeText, bytes))) {
+                std::cout << (cmd == "promote"
+                              ? "Usage: promote <virtual address> [size]\n"
+                              : "Usage: demote <virtual address>\n");
+                continue;
+            }
+            if (!vm.isInitialized()) {
+                std::cout << "Error: virtual memory not initialized "
+                             "(init vm <page_size> <phys_size>)\n";
+                continue;
+            }
+
+            if (cmd == "promote" && vm.promote(addr, bytes))
+                std::cout << "Promoted 0x" << std::hex << addr << std::dec
+                          << " to a " << bytes << "-byte page\n";
+            else if (cmd == "demote" && vm.demote(addr))
+                std::cout << "Demoted 0x" << std::hex << addr << std::dec
+                          << "\n";
+        }
+
+        // ---------- STREAMED TRACE ----------
+        else if (cmd == "stream") {
+            // stream <trace> [threads]
+            std::string path;
+            size_t threads = 0;
+            ss >> path >> threads;
+            if (path.empty()) {
+                std::cout << "Usage: stream <trace[.gz|.zst]> [threads]\n";
+                continue;
+            }
+            streamTrace(sim, path, threads);
+        }
+
+        // ---------- PAGING COMPARISON ----------
+        else if (cmd == "paging") {
+            // paging compare <trace>
+            std::string sub, path;
+            ss >> sub >> path;
+            if (sub != "compare" || path.empty()) {
+                std::cout << "Usage: paging compare <trace>\n";
+                continue;
+            }
+            if (!vm.isInitialized()) {
+                std::cout << "Error: virtual memory not initialized "
+                             "(init vm <page_size> <phys_size>)\n";
+                continue;
+            }
+
+            std::vector<PageRef> refs;
+            if (loadPageTrace(path, refs))
+                comparePaging(refs, vm.getPageSize(), vm.getPhysSize(),
+                              vm.getTau());
+        }
+
+        // ---------- ADDRESS SPACE ----------
+        else if (cmd == "asid") {
+            size_t id;
+            if (!(ss >> id)) {
+                std::cout << "Usage: asid <0-" << Tlb::MAX_ASID << ">\n";
+            }
+            else if (!vm.isInitialized()) {
+                std::cout << "Error: virtual memory not initialized "
+                             "(init vm <page_size> <phys_size>)\n";
+            }
+            else if (vm.setAsid(id)) {
+                std::cout << "Address space " << id << "\n";
+            }
+            else {
+                std::cout << "Error: ASID must be at most "
+                          << Tlb::MAX_ASID << "\n";
+            }
+        }
+
+        // ---------- TLB ----------
+        else if (cmd == "tlb") {
+            std::string sub;
+            ss >> sub;
+
+            if (sub.empty()) {
+                if (vm.numTlbLevels() == 0)
+                    std::cout << "No TLB levels\n";
+                for (size_t i = 0; i < vm.numTlbLevels(); i++) {
+                    if (i > 0)
+                        std::cout << "\n";
+                    vm.tlbLevel(i).stats(vm.getPageSize());
+                }
+            }
+            else if (sub == "add") {
+                // tlb add <name> <sets> <ways> [policy] [seed]
+                TlbConfig config;
+                std::string seedText;
+                config.policy = "LRU";
+                config.seed = 1;
+                if (!(ss >> config.name >> config.sets >> config.ways) ||
+                    config.sets == 0 || config.ways == 0) {
+                    std::cout
+                        << "Usage: tlb add <name> <sets> <ways> [policy] [seed]\n";
+                    continue;
+                }
+                ss >> config.policy >> seedText;
+                if (!seedText.empty())
+                    std::stringstream(seedText) >> config.seed;
+
+                ReplacementPolicy policy;
+                if (!parseReplacementPolicy(config.policy, policy)) {
+                    std::cout << "Unknown replacement policy\n";
+                    continue;
+                }
+                vm.addTlbLevel(config);
+                std::cout << "TLB level " << config.name << " added ("
+                          << config.sets * config.ways << " entries, "
+                          << replacementPolicyName(policy) << ")\n";
+            }
+            else if (sub == "clear") {
+                vm.clearTlb();
+                std::cout << "TLB levels removed\n";
+            }
+            else if (sub == "flush") {
+                size_t id;
+                if (ss >> id) {
+                    vm.flushTlb(static_cast<uint16_t>(id));
+                    std::cout << "TLB entries of ASID " << id
+                              << " flushed\n";
+                } else {
+                    vm.flushTlb();
+                    std::cout << "TLB flushed\n";
+                }
+            }
+            else {
+                std::cout
+                    << "Usage: tlb | tlb add <name> <sets> <ways> [policy] [seed] | tlb clear | tlb flush [asid]\n";
+            }
+        }
+
+        // ---------- MULTICORE ----------
+        else if (cmd == "multicore") {
+            // multicore <trace> [epoch] [threads]
+            std::string path;
+            size_t epoch = 256;
+            size_t threads = 0;
+            ss >> path >> epoch >> threads;
+
+            if (path.empty()) {
+                std::cout << "Usage: multicore <trace> [epoch] [threads]\n";
+                continue;
+            }
+            if (caches.numLevels() < 2) {
+                std::cout
+                    << "Error: multicore needs two cache levels (private L1, shared L2)\n";
+                continue;
+            }
+
+            std::vector<std::vector<CoreAccess>> streams;
+            if (!loadCoreTrace(path, streams))
+                continue;
+
+            CacheLevelConfig levelConfig[2];
+            for (size_t i = 0; i < 2; i++) {
+                const CacheModel& level = caches.level(i);
+                levelConfig[i] = CacheLevelConfig{
+                    level.getName(), level.getSets(), level.getWays(),
+                    level.getBlockSize(),
+                    replacementPolicyName(level.getPolicy()), 1};
+            }
+
+            // one worker thread per core unless told otherwise
+            if (threads == 0)
+                threads = streams.size();
+
+            MulticoreSim multicore(streams.size(), levelConfig[0],
+                                   levelConfig[1], epoch, threads);
+            multicore.run(streams);
+            multicore.stats();
+        }
+
         // ---------- CACHE ----------
         else if (cmd == "cache") {
-            std::cout << "\n=== Cache Hierarchy ===\n";
-            l1.stats();
-            std::cout << "\n";
-            l2.stats();
+            std::string sub;
+            ss >> sub;
+
+            if (sub.empty()) {
+                std::cout << "\n=== Cache Hierarchy ===\n";
+                caches.stats();
+            }
+            else if (sub == "load") {
+                std::string path;
+                ss >> path;
+                if (caches.loadConfig(path))
+                    std::cout << "Cache hierarchy loaded: "
+                              << caches.numLevels() << " levels\n";
+            }
+            else if (sub == "add") {
+                CacheLevelConfig config;
+                std::string seedText;
+                config.seed = 1;
+                if (!(ss >> config.name >> config.sets >> config.ways
+                         >> config.blockSize >> config.policy)) {
+                    std::cout
+                        << "Usage: cache add <name> <sets> <ways> <blockSize> <policy> [seed]\n";
+                    continue;
+                }
+                if (ss >> seedText)
+                    std::stringstream(seedText) >> config.seed;
+
+                if (caches.addLevel(config)) {
+                    caches.reset();
+                    std::cout << "Cache level " << config.name << " added ("
+                              << caches.numLevels() << " levels)\n";
+                }
+            }
+            else if (sub == "prefetch") {
+                std::string levelName, type, target;
+                ss >> levelName >> type;
+
+                if (levelName == "latency") {
+                    size_t latency = 0;
+                    if (std::stringstream(type) >> latency) {
+                        caches.setPrefetchLatency(latency);
+                        std::cout << "Prefetch latency: " << latency
+                                  << " requests\n";
+                    }
+                    else {
+                        std::cout << "Usage: cache prefetch latency <requests>\n";
+                    }
+                    continue;
+                }
+
+                PrefetchConfig config{PrefetcherType::NONE, 1, false};
+                int level = caches.findLevel(levelName);
+                if (level < 0 || !parsePrefetcherType(type, config.type)) {
+                    std::cout
+                        << "Usage: cache prefetch <level> <none|next_line|stride|stream> [degree] [same|next]\n";
+                    continue;
+                }
+                if (ss >> config.degree)
+                    ss >> target;
+                config.toNext = (target == "next");
+
+                caches.setPrefetcher(level, config);
+                std::cout << caches.level(level).getName() << " prefetcher: "
+                          << prefetcherTypeName(config.type);
+                if (config.type != PrefetcherType::NONE)
+                    std::cout << " (degree " << config.degree << ", into "
+                              << (config.toNext ? "next level" : "same level")
+                              << ")";
+                std::cout << "\n";
+            }
+            else if (sub == "curve") {
+                std::string arg;
+                ss >> arg;
+
+                if (arg == "on") {
+                    caches.setProfiling(true);
+                    std::cout << "Stack-distance profiling enabled\n";
+                }
+                else if (arg == "off") {
+                    caches.setProfiling(false);
+                    std::cout << "Stack-distance profiling disabled\n";
+                }
+                else if (!caches.isProfiling()) {
+                    std::cout << "Profiling is off (cache curve on)\n";
+                }
+                else if (arg == "csv") {
+                    std::string path;
+                    ss >> path;
+                    if (path.empty())
+                        std::cout << "Usage: cache curve csv <file>\n";
+                    else if (caches.getProfile().writeCsv(path))
+                        std::cout << "Hit-rate curve written to " << path << "\n";
+                }
+                else if (arg.empty()) {
+                    caches.getProfile().printCurve();
+                }
+                else {
+                    std::cout
+                        << "Usage: cache curve [on | off | csv <file>]\n";
+                }
+            }
+            else if (sub == "clear") {
+                caches.clear();
+                std::cout << "Cache hierarchy cleared\n";
+            }
+            else if (sub == "inclusion") {
+                std::string mode;
+                InclusionPolicy policy;
+                ss >> mode;
+                if (parseInclusionPolicy(mode, policy)) {
+                    caches.setInclusion(policy);
+                    std::cout << "Cache inclusion: "
+                              << inclusionPolicyName(policy) << "\n";
+                }
+                else {
+                    std::cout
+                        << "Usage: cache inclusion <inclusive|exclusive|nine>\n";
+                }
+            }
+            else {
+                std::cout
+                    << "Usage: cache [load <file> | add ... | clear | inclusion <mode> | prefetch ... | curve ...]\n";
+            }
         }
 
         // ---------- EXIT ----------
@@ -164,5 +1153,6 @@ int main() {
         }
     }
 
+    finishRun(sim, countingSink);
     return 0;
 }
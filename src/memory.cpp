@@ -9,26 +9,93 @@ Memory::Memory() {
     allocator = AllocatorType::FIRST_FIT;
     allocSuccess = 0;
     allocFail = 0;
+    sink = &defaultSink();
 }
 
 void Memory::init(size_t size) {
-    // reset old list if re-initialized
-    head = new Block{0, size, true, -1, nullptr};
+    // reclaim the old list in bulk if re-initialized
+    pool.reset();
+    head = pool.acquire();
+    *head = {0, size, true, -1, nullptr, nullptr, nullptr, nullptr};
+
+    freeIndex.clear();
+    tlsf.clear();
+    indexInsert(head);
+    blocksById.assign(1, nullptr);
 
     totalMemory = size;
     nextId = 1;
     allocSuccess = 0;
     allocFail = 0;
 
-    std::cout << "Memory initialized: " << size << " bytes\n";
+    sink->initialized(EventSource::MEMORY, size, 0);
 }
 
 void Memory::setAllocator(AllocatorType type) {
+    bool wasTlsf = allocator == AllocatorType::TLSF;
     allocator = type;
-    std::cout << "Allocator set\n";
+
+    // only the index of the active policy family is maintained
+    if (wasTlsf != (type == AllocatorType::TLSF))
+        rebuildIndex();
+
+    sink->allocatorSet();
+}
+
+void Memory::setSink(EventSink* eventSink) {
+    sink = eventSink;
+}
+
+// ---------- Free index ----------
+void Memory::indexInsert(Block* block) {
+    if (allocator == AllocatorType::TLSF)
+        tlsf.insert(block);
+    else
+        freeIndex.insert(block);
+}
+
+void Memory::indexErase(Block* block) {
+    if (allocator == AllocatorType::TLSF)
+        tlsf.erase(block);
+    else
+        freeIndex.erase(block);
+}
+
+void Memory::rebuildIndex() {
+    freeIndex.clear();
+    tlsf.clear();
+
+    for (Block* curr = head; curr; curr = curr->next) {
+        if (curr->free)
+            indexInsert(curr);
+    }
 }
 
 Block* Memory::findBlock(size_t size) {
+    if (allocator == AllocatorType::TLSF)
+        return tlsf.find(size);
+
+    if (size == 0)
+        return scanBlock(size);
+
+    switch (allocator) {
+    case AllocatorType::FIRST_FIT:
+        return freeIndex.firstFit(size);
+    case AllocatorType::BEST_FIT:
+        return freeIndex.bestFit(size);
+    case AllocatorType::WORST_FIT:
+        return freeIndex.worstFit(size);
+    default:
+        break;
+    }
+
+    return nullptr;
+}
+
+// Linear walk over the address-ordered list. Zero-byte requests can tie
+// with empty blocks sharing a start address, and only the list knows
+// which of those comes first.
+Block* Memory::scanBlock(size_t size) {
     Block* curr = head;
     Block* best = nullptr;
 
@@ -73,71 +140,109 @@ void Memory::splitBlock(Block* block, size_t size) {
     if (block->size == size)
         return;
 
-    Block* newBlock = new Block{
+    Block* newBlock = pool.acquire();
+    *newBlock = {
         block->start + size,
         block->size - size,
         true,
         -1,
-        block->next
+        block->next,
+        block,
+        nullptr,
+        nullptr
     };
 
+    if (block->next)
+        block->next->prev = newBlock;
+
     block->size = size;
     block->next = newBlock;
+
+    indexInsert(newBlock);
+    sink->split(EventSource::MEMORY, block->start, size, newBlock->size);
 }
 
 size_t Memory::mallocBlock(size_t size) {
+    int id;
+    return mallocBlock(size, id);
+}
+
+size_t Memory::mallocBlock(size_t size, int& id) {
+    id = -1;
     Block* block = findBlock(size);
     if (!block) {
         allocFail++;
-        std::cout << "Allocation failed\n";
+        sink->allocationFailed(EventSource::MEMORY, size);
         return static_cast<size_t>(-1);
     }
 
+    indexErase(block);
     splitBlock(block, size);
 
     block->free = false;
-    block->id = nextId++;
+    block->id = id = nextId++;
     allocSuccess++;
 
-    std::cout << "Allocated block id=" << block->id
-              << " at address=0x"
-              << std::hex << block->start << std::dec << "\n";
+    if (blocksById.size() <= static_cast<size_t>(block->id))
+        blocksById.resize(block->id + 1, nullptr);
+    blocksById[block->id] = block;
+
+    sink->allocated(EventSource::MEMORY, block->id, block->start, size);
 
     return block->start;
 }
 
 size_t Memory::freeBlock(int id) {
-    Block* curr = head;
+    if (id <= 0 || static_cast<size_t>(id) >= blocksById.size() ||
+        !blocksById[id]) {
+        sink->invalidFree(EventSource::MEMORY, id);
+        return static_cast<size_t>(-1);
+    }
 
-    while (curr) {
-        if (!curr->free && curr->id == id) {
-            curr->free = true;
-            curr->id = -1;
+    Block* block = blocksById[id];
+    blocksById[id] = nullptr;
 
-            size_t addr = curr->start;
-            coalesce();
+    block->free = true;
+    block->id = -1;
+    sink->freed(EventSource::MEMORY, id, FreeKind::MERGED);
 
-            std::cout << "Block " << id << " freed and merged\n";
-            return addr;
-        }
-        curr = curr->next;
+    size_t addr = block->start;
+    indexInsert(coalesce(block));
+    return addr;
+}
+
+// Merge a newly freed block with its direct neighbours. Every other pair of
+// adjacent free blocks was already merged, so nothing further can combine.
+// Returns the surviving block (not yet in the free index).
+Block* Memory::coalesce(Block* block) {
+    Block* next = block->next;
+    if (next && next->free) {
+        indexErase(next);
+
+        block->size += next->size;
+        block->next = next->next;
+        if (block->next)
+            block->next->prev = block;
+
+        pool.release(next);
+        sink->merged(EventSource::MEMORY, block->start, block->size);
     }
 
-    std::cout << "Invalid block id\n";
-    return static_cast<size_t>(-1);
-}
+    Block* prev = block->prev;
+    if (prev && prev->free) {
+        indexErase(prev);
 
-void Memory::coalesce() {
-    Block* curr = head;
+        prev->size += block->size;
+        prev->next = block->next;
+        if (prev->next)
+            prev->next->prev = prev;
 
-    while (curr && curr->next) {
-        if (curr->free && curr->next->free) {
-            curr->size += curr->next->size;
-            curr->next = curr->next->next;
-        } else {
-            curr = curr->next;
-        }
+        pool.release(block);
+        block = prev;
+        sink->merged(EventSource::MEMORY, block->start, block->size);
     }
+
+    return block;
 }
 
 void Memory::dump() {
@@ -157,6 +262,8 @@ void Memory::dump() {
 
         curr = curr->next;
     }
+    // later output (stats, the event sink's lines) expects decimal
+    std::cout << std::dec;
 }
 
 void Memory::stats() {
@@ -189,4 +296,6 @@ void Memory::stats() {
               << (double)used / totalMemory * 100.0 << "%\n";
     std::cout << "Allocation success: " << allocSuccess << "\n";
     std::cout << "Allocation failure: " << allocFail << "\n";
+    std::cout << "Block pool high-water mark: "
+              << pool.highWaterMark() << " blocks\n";
 }
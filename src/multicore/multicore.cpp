@@ -0,0 +1,413 @@
+#include "../../include/multicore/multicore.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <thread>
+
+// ================= Trace Loading =================
+bool loadCoreTrace(const std::string& path,
+                   std::vector<std::vector<CoreAccess>>& streams) {
+    std::ifstream in(path);
+    if (!in) {
+        std::cout << "Error: cannot open " << path << "\n";
+        return false;
+    }
+
+    streams.clear();
+    std::string line;
+    size_t lineNo = 0;
+
+    while (std::getline(in, line)) {
+        lineNo++;
+        line = line.substr(0, line.find('#'));
+
+        std::stringstream ss(line);
+        size_t core;
+        std::string op, text;
+        if (!(ss >> core))
+            continue;
+
+        ss >> op >> text;
+        size_t addr = 0;
+        std::stringstream parse(text);
+        if (text.compare(0, 2, "0x") == 0 || text.compare(0, 2, "0X") == 0)
+            parse.ignore(2) >> std::hex;
+
+        bool write = (op == "w" || op == "W");
+        if (!(parse >> addr) || (!write && op != "r" && op != "R") ||
+            core >= MulticoreSim::MAX_CORES) {
+            std::cout << path << ":" << lineNo
+                      << ": expected <core 0-63> <r|w> <address>\n";
+            return false;
+        }
+
+        if (core >= streams.size())
+            streams.resize(core + 1);
+        streams[core].push_back(CoreAccess{addr, write});
+    }
+
+    if (streams.empty()) {
+        std::cout << "Error: " << path << " has no accesses\n";
+        return false;
+    }
+    return true;
+}
+
+// ================= Constructor =================
+MulticoreSim::MulticoreSim(size_t numCores,
+                           const CacheLevelConfig& l1,
+                           const CacheLevelConfig& l2Config,
+                           size_t epochLength,
+                           size_t threads)
+    : blockSize(l1.blockSize),
+      epochLength(epochLength ? epochLength : 1),
+      threads(std::max<size_t>(1, std::min(threads, numCores))),
+      cores(numCores),
+      streams(nullptr),
+      getS(0),
+      getM(0),
+      upgradeRequests(0),
+      invalidations(0),
+      interventions(0),
+      cacheToCache(0),
+      putM(0),
+      memoryReads(0),
+      memoryWrites(0),
+      epochs(0),
+      elapsed(0.0)
+{
+    for (size_t c = 0; c < cores.size(); c++) {
+        Core& core = cores[c];
+        core.l1 = makeCache(l1.sets, l1.ways, l1.blockSize, l1.policy,
+                            l1.name + "." + std::to_string(c), l1.seed);
+        core.position = 0;
+        core.pending = Pending{false, CoreAccess{0, false}, false};
+        core.reads = 0;
+        core.writes = 0;
+        core.upgrades = 0;
+        core.demoted = 0;
+        core.invalidationsReceived = 0;
+        core.falseSharing = 0;
+        core.writebacks = 0;
+    }
+
+    // the shared level uses the private line size so lines map 1:1
+    this->l2 = makeCache(l2Config.sets, l2Config.ways, blockSize,
+                         l2Config.policy, l2Config.name, l2Config.seed);
+}
+
+// ================= Helpers =================
+size_t MulticoreSim::wordBit(size_t addr) const {
+    return size_t(1) << (((addr % blockSize) / 8) % 64);
+}
+
+// Parallel phase: replay core `c` until it needs the directory.
+void MulticoreSim::runLocal(size_t c) {
+    Core& core = cores[c];
+    if (core.pending.active)
+        return;
+
+    const std::vector<CoreAccess>& stream = (*streams)[c];
+    size_t end = std::min(stream.size(), core.position + epochLength);
+
+    while (core.position < end) {
+        const CoreAccess& access = stream[core.position];
+
+        if (!core.l1->lookup(access.addr, false)) {
+            core.pending = Pending{true, access, false};
+            return;
+        }
+
+        LineState& line = core.lines[access.addr / blockSize];
+        if (access.write) {
+            if (line.state == MesiState::SHARED) {
+                core.pending = Pending{true, access, true};
+                return;
+            }
+            line.state = MesiState::MODIFIED;   // E -> M is silent
+            core.writes++;
+        }
+        else {
+            core.reads++;
+        }
+
+        line.words |= wordBit(access.addr);
+        core.position++;
+    }
+}
+
+void MulticoreSim::readFromL2(size_t addr) {
+    if (l2->lookup(addr, false))
+        return;
+
+    memoryReads++;
+    CacheVictim victim;
+    if (l2->fill(addr, false, victim) && victim.dirty)
+        memoryWrites++;
+}
+
+void MulticoreSim::writeBackToL2(size_t addr) {
+    putM++;
+    if (l2->markDirty(addr))
+        return;
+
+    CacheVictim victim;
+    if (l2->fill(addr, true, victim) && victim.dirty)
+        memoryWrites++;
+}
+
+// Invalidates core `k`'s copy of `line` because another core writes
+// `writerAddr`. The copy was falsely shared if `k` never touched that word.
+void MulticoreSim::dropCopy(size_t k, size_t line, size_t writerAddr) {
+    Core& core = cores[k];
+    bool wasDirty = false;
+    core.l1->invalidate(line * blockSize, wasDirty);
+
+    auto it = core.lines.find(line);
+    if (it != core.lines.end()) {
+        if (!(it->second.words & wordBit(writerAddr)))
+            core.falseSharing++;
+        core.lines.erase(it);
+    }
+
+    core.invalidationsReceived++;
+    invalidations++;
+}
+
+// Installs a line in core `c`'s L1 and retires whatever it displaces.
+void MulticoreSim::fillL1(size_t c, size_t addr, MesiState state) {
+    Core& core = cores[c];
+    CacheVictim victim;
+
+    if (core.l1->fill(addr, false, victim)) {
+        size_t victimLine = victim.addr / blockSize;
+
+        auto it = core.lines.find(victimLine);
+        if (it != core.lines.end()) {
+            if (it->second.state == MesiState::MODIFIED) {
+                writeBackToL2(victim.addr);
+                core.writebacks++;
+            }
+            core.lines.erase(it);
+        }
+
+        auto entry = directory.find(victimLine);
+        if (entry != directory.end()) {
+            entry->second.sharers &= ~(uint64_t(1) << c);
+            if (entry->second.owner == static_cast<int>(c))
+                entry->second.owner = -1;
+            if (entry->second.sharers == 0)
+                directory.erase(entry);
+        }
+    }
+
+    core.lines[addr / blockSize] = LineState{state, wordBit(addr)};
+}
+
+// Serial phase: the directory handles core `c`'s stalled access.
+void MulticoreSim::serve(size_t c) {
+    Core& core = cores[c];
+    CoreAccess access = core.pending.access;
+    bool upgrade = core.pending.upgrade;
+    core.pending.active = false;
+
+    size_t line = access.addr / blockSize;
+    uint64_t self = uint64_t(1) << c;
+
+    // a core served earlier in this phase may have invalidated the
+    // shared copy: the upgrade becomes a write miss. runLocal's lookup
+    // already counted an L1 hit, so stats() moves it to the misses
+    if (upgrade && core.lines.find(line) == core.lines.end()) {
+        upgrade = false;
+        core.demoted++;
+    }
+
+    DirectoryEntry entry = {0, -1};
+    auto found = directory.find(line);
+    if (found != directory.end())
+        entry = found->second;
+
+    // every other copy goes on a write
+    auto invalidateOthers = [&]() {
+        uint64_t others = entry.sharers & ~self;
+        while (others) {
+            size_t k = __builtin_ctzll(others);
+            dropCopy(k, line, access.addr);
+            others &= others - 1;
+        }
+    };
+
+    MesiState state;
+
+    if (upgrade) {
+        // ---------- S -> M ----------
+        upgradeRequests++;
+        core.upgrades++;
+        invalidateOthers();
+        directory[line] = DirectoryEntry{self, static_cast<int>(c)};
+
+        LineState& mine = core.lines[line];
+        mine.state = MesiState::MODIFIED;
+        mine.words |= wordBit(access.addr);
+        core.writes++;
+        core.position++;
+        return;
+    }
+
+    if (access.write) {
+        // ---------- GetM (read for ownership) ----------
+        getM++;
+        if (entry.owner >= 0)
+            cacheToCache++;        // owner hands the line over
+        else
+            readFromL2(access.addr);
+        invalidateOthers();
+        state = MesiState::MODIFIED;
+        directory[line] = DirectoryEntry{self, static_cast<int>(c)};
+        core.writes++;
+    }
+    else {
+        // ---------- GetS ----------
+        getS++;
+        if (entry.owner >= 0) {
+            // owner downgrades to S, flushing dirty data to L2
+            Core& owner = cores[entry.owner];
+            LineState& theirs = owner.lines[line];
+            if (theirs.state == MesiState::MODIFIED)
+                writeBackToL2(access.addr);
+            theirs.state = MesiState::SHARED;
+            interventions++;
+            cacheToCache++;
+            state = MesiState::SHARED;
+        }
+        else {
+            readFromL2(access.addr);
+            state = entry.sharers ? MesiState::SHARED : MesiState::EXCLUSIVE;
+        }
+
+        int owner = (state == MesiState::EXCLUSIVE) ? static_cast<int>(c) : -1;
+        directory[line] = DirectoryEntry{entry.sharers | self, owner};
+        core.reads++;
+    }
+
+    fillL1(c, access.addr, state);
+    core.position++;
+}
+
+// ================= Replay =================
+double MulticoreSim::run(const std::vector<std::vector<CoreAccess>>& input) {
+    streams = &input;
+    auto start = std::chrono::steady_clock::now();
+
+    auto remaining = [&]() {
+        for (size_t c = 0; c < cores.size(); c++) {
+            if (cores[c].position < input[c].size())
+                return true;
+        }
+        return false;
+    };
+
+    // ---------- Workers ----------
+    // workers spin (yielding) on an epoch counter instead of sleeping:
+    // epochs are short, and waking from a condition variable would cost
+    // more than the epoch itself
+    std::atomic<uint64_t> generation(0);
+    std::atomic<size_t> done(0);
+    std::atomic<bool> stop(false);
+    std::vector<std::thread> workers;
+
+    if (threads > 1) {
+        for (size_t t = 0; t < threads; t++) {
+            workers.emplace_back([&, t]() {
+                uint64_t seen = 0;
+                while (true) {
+                    while (generation.load(std::memory_order_acquire) == seen)
+                        std::this_thread::yield();
+                    seen++;
+                    if (stop.load(std::memory_order_acquire))
+                        return;
+
+                    for (size_t c = t; c < cores.size(); c += threads)
+                        runLocal(c);
+                    done.fetch_add(1, std::memory_order_release);
+                }
+            });
+        }
+    }
+
+    // ---------- Epochs ----------
+    while (remaining()) {
+        epochs++;
+
+        if (threads > 1) {
+            done.store(0, std::memory_order_relaxed);
+            generation.fetch_add(1, std::memory_order_release);
+            while (done.load(std::memory_order_acquire) < threads)
+                std::this_thread::yield();
+        }
+        else {
+            for (size_t c = 0; c < cores.size(); c++)
+                runLocal(c);
+        }
+
+        for (size_t c = 0; c < cores.size(); c++) {
+            if (cores[c].pending.active)
+                serve(c);
+        }
+    }
+
+    if (threads > 1) {
+        stop.store(true, std::memory_order_release);
+        generation.fetch_add(1, std::memory_order_release);
+        for (std::thread& worker : workers)
+            worker.join();
+    }
+
+    elapsed = std::chrono::duration<double>(
+        std::chrono::steady_clock::now() - start).count();
+    streams = nullptr;
+    return elapsed;
+}
+
+// ================= Stats =================
+void MulticoreSim::stats() const {
+    std::cout << std::dec;
+    std::cout << "=== Multicore (MESI) ===\n";
+    std::cout << "Cores    : " << cores.size() << " (" << threads
+              << " threads, epoch " << epochLength << ")\n";
+    std::cout << "Epochs   : " << epochs << "\n";
+    std::cout << "Replay   : " << elapsed * 1000.0 << " ms\n";
+
+    std::cout << "\nCore\tReads\tWrites\tL1 Hits\tL1 Miss\tUpgrade"
+                 "\tInvRecv\tFalseSh\tWBacks\n";
+    for (size_t c = 0; c < cores.size(); c++) {
+        const Core& core = cores[c];
+        std::cout << c << "\t" << core.reads << "\t" << core.writes << "\t"
+                  << core.l1->getHits() - core.demoted << "\t"
+                  << core.l1->getMisses() + core.demoted << "\t"
+                  << core.upgrades << "\t" << core.invalidationsReceived << "\t"
+                  << core.falseSharing << "\t" << core.writebacks << "\n";
+    }
+
+    size_t falseSharing = 0;
+    for (const Core& core : cores)
+        falseSharing += core.falseSharing;
+
+    std::cout << "\nCoherence traffic\n";
+    std::cout << "GetS (read miss)      : " << getS << "\n";
+    std::cout << "GetM (write miss)     : " << getM << "\n";
+    std::cout << "Upgrades (S -> M)     : " << upgradeRequests << "\n";
+    std::cout << "Invalidations         : " << invalidations << "\n";
+    std::cout << "False-sharing inval.  : " << falseSharing << "\n";
+    std::cout << "Interventions (->S)   : " << interventions << "\n";
+    std::cout << "Cache-to-cache        : " << cacheToCache << "\n";
+    std::cout << "Writebacks to L2      : " << putM << "\n";
+
+    std::cout << "\nShared ";
+    l2->stats();
+    std::cout << "Memory reads : " << memoryReads << "\n";
+    std::cout << "Memory writes: " << memoryWrites << "\n";
+}
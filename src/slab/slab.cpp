@@ -0,0 +1,265 @@
+#include "../../include/slab/slab.h"
+#include <iostream>
+
+// object sizes of the slab caches, smallest first
+static const size_t CLASS_SIZES[] = {
+    8, 16, 32, 48, 64, 96, 128, 192, 256, 384, 512, 768, 1024
+};
+
+// ---------- Constructor ----------
+SlabAllocator::SlabAllocator()
+    : slabSize(0),
+      nextId(1),
+      slabFragmentation(0),
+      buddyEquivalent(0),
+      sink(&defaultSink()) {}
+
+// ---------- Init ----------
+void SlabAllocator::init(size_t size) {
+    buddy.reset(size);
+    slabSize = size < SLAB_SIZE ? size : SLAB_SIZE;
+
+    // keep classes that fit at least four objects per slab
+    classes.clear();
+    for (size_t objectSize : CLASS_SIZES) {
+        if (objectSize * 4 > slabSize)
+            break;
+        classes.push_back({objectSize, slabSize / objectSize, {}, 0, 0});
+    }
+
+    classBySize.clear();
+    if (!classes.empty()) {
+        size_t maxSize = classes.back().objectSize;
+        int c = 0;
+        for (size_t i = 0; i <= maxSize / 8; i++) {
+            while (classes[c].objectSize < i * 8)
+                c++;
+            classBySize.push_back(c);
+        }
+    }
+
+    slabs.clear();
+    spareSlabs.clear();
+    slabByPage.assign(size / slabSize, -1);
+
+    objects.assign(1, {0, 0, -1, -1, false});
+    nextId = 1;
+    slabFragmentation = 0;
+    buddyEquivalent = 0;
+
+    sink->initialized(EventSource::SLAB, size, slabSize);
+}
+
+void SlabAllocator::setSink(EventSink* eventSink) {
+    sink = eventSink;
+}
+
+// ---------- Helpers ----------
+size_t SlabAllocator::roundPow2(size_t size) {
+    size_t block = 1;
+    while (block < size)
+        block <<= 1;
+    return block;
+}
+
+int SlabAllocator::classFor(size_t size) const {
+    size_t index = (size + 7) / 8;
+    if (index >= classBySize.size())
+        return -1;
+    return classBySize[index];
+}
+
+// take a fresh page from the buddy allocator for a size class
+int SlabAllocator::newSlab(int sizeClass) {
+    int pageId;
+    size_t addr = buddy.allocate(slabSize, pageId);
+    if (addr == static_cast<size_t>(-1))
+        return -1;
+
+    int index;
+    if (!spareSlabs.empty()) {
+        index = spareSlabs.back();
+        spareSlabs.pop_back();
+    } else {
+        index = static_cast<int>(slabs.size());
+        slabs.emplace_back();
+    }
+
+    SizeClass& sc = classes[sizeClass];
+    Slab& slab = slabs[index];
+    slab.addr = addr;
+    slab.pageId = pageId;
+    slab.sizeClass = sizeClass;
+    slab.used = 0;
+
+    // hand out objects from the start of the slab first
+    slab.freeObjects.clear();
+    for (size_t i = sc.objectsPerSlab; i > 0; i--)
+        slab.freeObjects.push_back(static_cast<unsigned>(i - 1));
+
+    slab.partialPos = sc.partial.size();
+    sc.partial.push_back(index);
+    sc.slabs++;
+
+    slabByPage[addr / slabSize] = index;
+    return index;
+}
+
+void SlabAllocator::removePartial(Slab& slab) {
+    std::vector<int>& partial = classes[slab.sizeClass].partial;
+
+    // swap-remove, fixing up the moved slab's position
+    int last = partial.back();
+    partial[slab.partialPos] = last;
+    slabs[last].partialPos = slab.partialPos;
+    partial.pop_back();
+
+    slab.partialPos = NO_PARTIAL;
+}
+
+// ---------- Malloc ----------
+int SlabAllocator::mallocBlock(size_t size) {
+    int c = classFor(size);
+    Object obj{0, size, c, -1, true};
+    size_t blockSize;
+
+    if (c == -1) {
+        // too large for any cache: plain buddy block
+        obj.addr = buddy.allocate(size, obj.owner);
+        if (obj.addr == static_cast<size_t>(-1)) {
+            sink->allocationFailed(EventSource::SLAB, size);
+            return -1;
+        }
+        blockSize = roundPow2(size);
+    } else {
+        SizeClass& sc = classes[c];
+        if (sc.partial.empty() && newSlab(c) == -1) {
+            sink->allocationFailed(EventSource::SLAB, size);
+            return -1;
+        }
+
+        obj.owner = sc.partial.back();
+        Slab& slab = slabs[obj.owner];
+
+        unsigned slot = slab.freeObjects.back();
+        slab.freeObjects.pop_back();
+        slab.used++;
+        if (slab.freeObjects.empty())
+            removePartial(slab);
+
+        obj.addr = slab.addr + slot * sc.objectSize;
+        blockSize = sc.objectSize;
+
+        sc.liveObjects++;
+        slabFragmentation += sc.objectSize - size;
+    }
+
+    buddyEquivalent += roundPow2(size) - size;
+
+    objects.push_back(obj);
+    int id = nextId++;
+
+    sink->allocated(EventSource::SLAB, id, obj.addr, blockSize);
+    return id;
+}
+
+// ---------- Free ----------
+void SlabAllocator::freeBlock(int id) {
+    if (id <= 0 || static_cast<size_t>(id) >= objects.size() ||
+        !objects[id].live) {
+        sink->invalidFree(EventSource::SLAB, id);
+        return;
+    }
+
+    Object& obj = objects[id];
+    obj.live = false;
+    buddyEquivalent -= roundPow2(obj.requestedSize) - obj.requestedSize;
+
+    if (obj.sizeClass == -1) {
+        buddy.release(obj.owner);
+    } else {
+        SizeClass& sc = classes[obj.sizeClass];
+        Slab& slab = slabs[obj.owner];
+
+        slab.freeObjects.push_back(
+            static_cast<unsigned>((obj.addr - slab.addr) / sc.objectSize));
+        slab.used--;
+
+        sc.liveObjects--;
+        slabFragmentation -= sc.objectSize - obj.requestedSize;
+
+        if (slab.partialPos == NO_PARTIAL) {
+            slab.partialPos = sc.partial.size();
+            sc.partial.push_back(obj.owner);
+        }
+
+        // empty slabs go back to the buddy allocator
+        if (slab.used == 0) {
+            removePartial(slab);
+            buddy.release(slab.pageId);
+            slabByPage[slab.addr / slabSize] = -1;
+            spareSlabs.push_back(obj.owner);
+            sc.slabs--;
+        }
+    }
+
+    sink->freed(EventSource::SLAB, id, FreeKind::RETURNED);
+}
+
+// ---------- Dump ----------
+void SlabAllocator::dump() const {
+    for (int index : slabByPage) {
+        if (index == -1)
+            continue;
+
+        const Slab& slab = slabs[index];
+        const SizeClass& sc = classes[slab.sizeClass];
+
+        std::cout << "[0x" << std::hex << slab.addr
+                  << " - 0x" << (slab.addr + slabSize - 1)
+                  << "] SLAB size=" << std::dec << sc.objectSize
+                  << " used=" << slab.used
+                  << "/" << sc.objectsPerSlab << "\n";
+    }
+
+    buddy.dump();
+    std::cout << std::dec;
+}
+
+// ---------- Stats ----------
+void SlabAllocator::stats() const {
+    std::cout << std::dec << "Slab size: " << slabSize << " bytes\n";
+
+    for (const SizeClass& sc : classes) {
+        if (sc.slabs == 0)
+            continue;
+
+        size_t capacity = sc.slabs * sc.objectsPerSlab;
+        std::cout << "Class " << sc.objectSize
+                  << ": slabs=" << sc.slabs
+                  << " objects=" << sc.liveObjects << "/" << capacity
+                  << " (" << (double)sc.liveObjects / capacity * 100.0
+                  << "%)\n";
+    }
+
+    size_t slabFrag = getInternalFragmentation();
+    size_t buddyFrag = getBuddyFragmentation();
+
+    std::cout << "Slab internal fragmentation: " << slabFrag << " bytes\n";
+    std::cout << "Plain buddy internal fragmentation: "
+              << buddyFrag << " bytes\n";
+    std::cout << "Internal fragmentation saved: "
+              << static_cast<long long>(buddyFrag) -
+                 static_cast<long long>(slabFrag)
+              << " bytes\n";
+}
+
+size_t SlabAllocator::getInternalFragmentation() const {
+    // slab pages are whole buddy blocks, so the buddy only wastes space on
+    // the large requests it served directly
+    return slabFragmentation + buddy.getInternalFragmentation();
+}
+
+size_t SlabAllocator::getBuddyFragmentation() const {
+    return buddyEquivalent;
+}
@@ -0,0 +1,99 @@
+#include "../include/tlsf_index.h"
+#include "../include/memory.h"
+
+// ---------- Constructor ----------
+TlsfIndex::TlsfIndex() {
+    clear();
+}
+
+void TlsfIndex::clear() {
+    flBitmap = 0;
+    for (int fl = 0; fl < FL_COUNT; fl++) {
+        slBitmap[fl] = 0;
+        for (int sl = 0; sl < SL_COUNT; sl++)
+            heads[fl][sl] = nullptr;
+    }
+}
+
+// ---------- Helpers ----------
+// size -> (first level, second level) class
+void TlsfIndex::mapping(size_t size, int& fl, int& sl) {
+    if (size < static_cast<size_t>(SL_COUNT)) {
+        // small sizes get one class each
+        fl = 0;
+        sl = static_cast<int>(size);
+        return;
+    }
+
+    int msb = 63 - __builtin_clzll(size);
+    fl = msb - SL_BITS + 1;
+    sl = static_cast<int>(size >> (msb - SL_BITS)) ^ SL_COUNT;
+}
+
+// ---------- Update ----------
+void TlsfIndex::insert(Block* block) {
+    int fl, sl;
+    mapping(block->size, fl, sl);
+
+    Block* first = heads[fl][sl];
+    block->prevFree = nullptr;
+    block->nextFree = first;
+    if (first)
+        first->prevFree = block;
+    heads[fl][sl] = block;
+
+    flBitmap |= 1ull << fl;
+    slBitmap[fl] |= 1u << sl;
+}
+
+void TlsfIndex::erase(Block* block) {
+    int fl, sl;
+    mapping(block->size, fl, sl);
+
+    if (block->prevFree)
+        block->prevFree->nextFree = block->nextFree;
+    else
+        heads[fl][sl] = block->nextFree;
+
+    if (block->nextFree)
+        block->nextFree->prevFree = block->prevFree;
+
+    block->nextFree = block->prevFree = nullptr;
+
+    if (!heads[fl][sl]) {
+        slBitmap[fl] &= ~(1u << sl);
+        if (!slBitmap[fl])
+            flBitmap &= ~(1ull << fl);
+    }
+}
+
+// ---------- Query ----------
+Block* TlsfIndex::find(size_t size) const {
+    // round up so every block in the chosen class fits
+    if (size >= static_cast<size_t>(SL_COUNT)) {
+        int msb = 63 - __builtin_clzll(size);
+        size_t round = (static_cast<size_t>(1) << (msb - SL_BITS)) - 1;
+        if (size > static_cast<size_t>(-1) - round)
+            return nullptr;
+        size += round;
+    }
+
+    int fl, sl;
+    mapping(size, fl, sl);
+
+    uint32_t slMap = slBitmap[fl] & (~0u << sl);
+    if (!slMap) {
+        if (fl + 1 >= FL_COUNT)
+            return nullptr;
+
+        uint64_t flMap = flBitmap & (~0ull << (fl + 1));
+        if (!flMap)
+            return nullptr;
+
+        fl = __builtin_ctzll(flMap);
+        slMap = slBitmap[fl];
+    }
+
+    sl = __builtin_ctz(slMap);
+    return heads[fl][sl];
+}
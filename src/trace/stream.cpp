@@ -0,0 +1,295 @@
+#include "../../include/trace/stream.h"
+#include <sys/wait.h>
+#include <cstring>
+#include <iostream>
+#include <vector>
+
+static const size_t READ_BYTES = 1 << 20;
+
+// ---------- helpers ----------
+static bool endsWith(const std::string& text, const char* suffix) {
+    size_t n = std::strlen(suffix);
+    return text.size() >= n && text.compare(text.size() - n, n, suffix) == 0;
+}
+
+// single-quoted for /bin/sh
+static std::string shellQuote(const std::string& text) {
+    std::string quoted = "'";
+    for (char c : text) {
+        if (c == '\'')
+            quoted += "'\\''";
+        else
+            quoted += c;
+    }
+    return quoted + "'";
+}
+
+static const char* skipSpaces(const char* p, const char* end) {
+    while (p < end && (*p == ' ' || *p == '\t'))
+        p++;
+    return p;
+}
+
+// hex digits (optional 0x) up to the first non-digit; false if none
+static bool parseHex(const char*& p, const char* end, uint64_t& value) {
+    if (end - p > 2 && p[0] == '0' && (p[1] == 'x' || p[1] == 'X'))
+        p += 2;
+    const char* start = p;
+    value = 0;
+    while (p < end) {
+        char c = *p;
+        unsigned digit;
+        if (c >= '0' && c <= '9')       digit = c - '0';
+        else if (c >= 'a' && c <= 'f')  digit = c - 'a' + 10;
+        else if (c >= 'A' && c <= 'F')  digit = c - 'A' + 10;
+        else break;
+        value = (value << 4) | digit;
+        p++;
+    }
+    return p != start && p - start <= 16;
+}
+
+// 0x-prefixed hex or decimal, as in the command scripts
+static bool parseNumber(const char*& p, const char* end, uint64_t& value) {
+    if (end - p > 2 && p[0] == '0' && (p[1] == 'x' || p[1] == 'X'))
+        return parseHex(p, end, value);
+    const char* start = p;
+    value = 0;
+    while (p < end && *p >= '0' && *p <= '9')
+        value = value * 10 + (*p++ - '0');
+    return p != start;
+}
+
+// ---------- Constructor ----------
+TraceStream::TraceStream()
+    : done(false),
+      cancel(false),
+      holding(false),
+      file(nullptr),
+      piped(false),
+      stats{0, 0, 0, 0, 0, 0, 0},
+      readError(false)
+{
+}
+
+TraceStream::~TraceStream() {
+    if (producer.joinable() || file)
+        finish();
+}
+
+// ---------- Open / Finish ----------
+bool TraceStream::open(const std::string& tracePath) {
+    path = tracePath;
+
+    std::FILE* probe = std::fopen(path.c_str(), "rb");
+    if (!probe) {
+        std::cout << "Error: cannot open " << path << "\n";
+        return false;
+    }
+
+    if (endsWith(path, ".gz") || endsWith(path, ".zst") ||
+        endsWith(path, ".zstd")) {
+        std::fclose(probe);
+        std::string tool = endsWith(path, ".gz") ? "gzip" : "zstd";
+        std::string command = tool + " -dc " + shellQuote(path);
+        file = popen(command.c_str(), "r");
+        piped = true;
+        if (!file) {
+            std::cout << "Error: cannot start " << tool << "\n";
+            return false;
+        }
+    } else {
+        file = probe;
+        piped = false;
+    }
+
+    producer = std::thread(&TraceStream::produce, this);
+    return true;
+}
+
+bool TraceStream::finish() {
+    if (producer.joinable()) {
+        if (!done.load(std::memory_order_acquire))
+            cancel.store(true, std::memory_order_release);
+        producer.join();
+    }
+    if (!file)
+        return !readError;
+
+    bool ok = !readError;
+    if (piped) {
+        int status = pclose(file);
+        // a decompressor killed by the early stop is not an error
+        if (!cancel.load() && (status == -1 || !WIFEXITED(status) ||
+                               WEXITSTATUS(status) != 0)) {
+            std::cout << "Error: decompressing " << path << " failed\n";
+            ok = false;
+        }
+    } else {
+        std::fclose(file);
+    }
+    file = nullptr;
+
+    if (readError)
+        std::cout << "Error: reading " << path << " failed\n";
+    return ok;
+}
+
+// ---------- Consumer ----------
+bool TraceStream::next(const TraceAccess*& accesses, size_t& count) {
+    if (holding) {
+        ring.pop();
+        holding = false;
+    }
+
+    while (true) {
+        if (Batch* batch = ring.front()) {
+            holding = true;
+            accesses = batch->items;
+            count = batch->count;
+            return true;
+        }
+        if (done.load(std::memory_order_acquire)) {
+            // the last batch may have landed just before `done`
+            if (ring.front())
+                continue;
+            return false;
+        }
+        std::this_thread::yield();
+    }
+}
+
+const StreamStats& TraceStream::getStats() const {
+    return stats;
+}
+
+// ---------- Producer ----------
+TraceStream::Batch* TraceStream::claimBatch() {
+    while (true) {
+        if (Batch* batch = ring.claim()) {
+            batch->count = 0;
+            return batch;
+        }
+        if (cancel.load(std::memory_order_acquire))
+            return nullptr;
+        std::this_thread::yield();
+    }
+}
+
+void TraceStream::emit(uint64_t addr, bool write, Batch*& batch) {
+    batch->items[batch->count++] = TraceAccess{addr, write};
+    stats.accesses++;
+    if (write)
+        stats.writes++;
+    else
+        stats.reads++;
+
+    if (batch->count == BATCH) {
+        ring.publish();
+        batch = claimBatch();
+    }
+}
+
+void TraceStream::parseLine(const char* p, const char* end, Batch*& batch) {
+    stats.lines++;
+    if (const void* hash = std::memchr(p, '#', end - p))
+        end = static_cast<const char*>(hash);
+    p = skipSpaces(p, end);
+    while (end > p && (end[-1] == '\r' || end[-1] == ' ' || end[-1] == '\t'))
+        end--;
+
+    if (p == end || (end - p >= 2 && p[0] == '=' && p[1] == '=')) {
+        stats.ignored++;
+        return;
+    }
+
+    uint64_t addr = 0;
+    char kind = *p;
+    bool spaced = end - p > 1 && (p[1] == ' ' || p[1] == '\t');
+
+    // ---------- Valgrind lackey: "<I|L|S|M> addr,size" ----------
+    if (spaced && (kind == 'I' || kind == 'L' || kind == 'S' || kind == 'M')) {
+        p = skipSpaces(p + 1, end);
+        if (!parseHex(p, end, addr) || p == end || *p != ',') {
+            stats.malformed++;
+            return;
+        }
+        if (kind == 'I')
+            stats.instructions++;
+        else if (kind == 'L')
+            emit(addr, false, batch);
+        else if (kind == 'S')
+            emit(addr, true, batch);
+        else {
+            emit(addr, false, batch);
+            if (batch)
+                emit(addr, true, batch);
+        }
+        return;
+    }
+
+    // ---------- memsim: "<r|w> addr" ----------
+    if (spaced && (kind == 'r' || kind == 'R' || kind == 'w' || kind == 'W')) {
+        p = skipSpaces(p + 1, end);
+        if (!parseNumber(p, end, addr) || p != end) {
+            stats.malformed++;
+            return;
+        }
+        emit(addr, kind == 'w' || kind == 'W', batch);
+        return;
+    }
+
+    // ---------- pinatrace: "ip: <R|W> addr" ----------
+    const char* colon = static_cast<const char*>(std::memchr(p, ':', end - p));
+    if (colon) {
+        p = skipSpaces(colon + 1, end);
+        if (p < end && (*p == 'R' || *p == 'W')) {
+            bool write = *p == 'W';
+            p = skipSpaces(p + 1, end);
+            if (parseHex(p, end, addr) && skipSpaces(p, end) == end) {
+                emit(addr, write, batch);
+                return;
+            }
+        }
+    }
+    stats.malformed++;
+}
+
+void TraceStream::produce() {
+    std::vector<char> buffer(READ_BYTES);
+    size_t kept = 0;            // partial line carried to the next read
+    Batch* batch = claimBatch();
+
+    while (batch) {
+        if (kept == buffer.size())
+            buffer.resize(buffer.size() * 2);   // one very long line
+
+        size_t got = std::fread(buffer.data() + kept, 1,
+                                buffer.size() - kept, file);
+        if (got == 0) {
+            if (std::ferror(file))
+                readError = true;
+            if (kept > 0)
+                parseLine(buffer.data(), buffer.data() + kept, batch);
+            break;
+        }
+
+        const char* p = buffer.data();
+        const char* end = buffer.data() + kept + got;
+        while (batch) {
+            const char* newline = static_cast<const char*>(
+                std::memchr(p, '\n', end - p));
+            if (!newline)
+                break;
+            parseLine(p, newline, batch);
+            p = newline + 1;
+        }
+
+        kept = end - p;
+        std::memmove(buffer.data(), p, kept);
+    }
+
+    if (batch && batch->count > 0)
+        ring.publish();
+    done.store(true, std::memory_order_release);
+}
@@ -0,0 +1,349 @@
+#include "../../include/trace/trace.h"
+#include "../../include/memory.h"
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <algorithm>
+#include <iostream>
+#include <sstream>
+
+static const char MAGIC[4] = {'M', 'S', 'T', 'R'};
+static const uint8_t VERSION = 1;
+static const size_t HEADER_BYTES = 16;
+static const size_t FLUSH_BYTES = 1 << 16;
+
+// ---------- helpers ----------
+// delta stream of an opcode: reads and writes share the address stream
+static size_t streamOf(TraceOp op) {
+    return op == TraceOp::WRITE ? static_cast<size_t>(TraceOp::READ)
+                                : static_cast<size_t>(op);
+}
+
+static bool isKnownOp(uint8_t op) {
+    return op >= static_cast<uint8_t>(TraceOp::INIT_MEMORY) &&
+           op <= static_cast<uint8_t>(TraceOp::WRITE);
+}
+
+static bool isPowerOfTwo(size_t x) {
+    return x && !(x & (x - 1));
+}
+
+const char* traceOpName(TraceOp op) {
+    switch (op) {
+    case TraceOp::INIT_MEMORY:      return "init memory";
+    case TraceOp::INIT_BUDDY:       return "init buddy";
+    case TraceOp::INIT_SLAB:        return "init slab";
+    case TraceOp::INIT_VM:          return "init vm";
+    case TraceOp::SET_ALLOCATOR:    return "set allocator";
+    case TraceOp::MALLOC:           return "malloc";
+    case TraceOp::FREE:             return "free";
+    case TraceOp::READ:             return "read";
+    case TraceOp::WRITE:            return "write";
+    }
+    return "?";
+}
+
+// ================= Writer =================
+TraceWriter::TraceWriter()
+    : encoding(TraceEncoding::FIXED),
+      previous{},
+      records(0),
+      bytes(0)
+{
+}
+
+TraceWriter::~TraceWriter() {
+    if (out.is_open())
+        close();
+}
+
+bool TraceWriter::open(const std::string& path, TraceEncoding enc) {
+    out.open(path, std::ios::binary | std::ios::trunc);
+    if (!out) {
+        std::cout << "Error: cannot create " << path << "\n";
+        return false;
+    }
+
+    encoding = enc;
+    std::fill(previous, previous + 16, 0);
+    records = 0;
+    buffer.clear();
+
+    // the count is patched in by close()
+    uint8_t header[HEADER_BYTES] = {};
+    std::copy(MAGIC, MAGIC + 4, header);
+    header[4] = VERSION;
+    header[5] = static_cast<uint8_t>(encoding);
+    out.write(reinterpret_cast<const char*>(header), HEADER_BYTES);
+    bytes = HEADER_BYTES;
+    return true;
+}
+
+void TraceWriter::append(TraceOp op, uint64_t arg) {
+    if (encoding == TraceEncoding::FIXED) {
+        uint64_t word = (static_cast<uint64_t>(op) << 56) | (arg & MAX_ARG);
+        const uint8_t* raw = reinterpret_cast<const uint8_t*>(&word);
+        buffer.insert(buffer.end(), raw, raw + 8);
+    } else {
+        uint64_t& last = previous[streamOf(op)];
+        int64_t delta = static_cast<int64_t>(arg - last);
+        last = arg;
+
+        // zigzag, then 7 bits per byte, low groups first
+        uint64_t value = (static_cast<uint64_t>(delta) << 1) ^
+                         static_cast<uint64_t>(delta >> 63);
+        buffer.push_back(static_cast<uint8_t>(op));
+        while (value >= 0x80) {
+            buffer.push_back(static_cast<uint8_t>(value | 0x80));
+            value >>= 7;
+        }
+        buffer.push_back(static_cast<uint8_t>(value));
+    }
+
+    records++;
+    if (buffer.size() >= FLUSH_BYTES)
+        flush();
+}
+
+void TraceWriter::flush() {
+    out.write(reinterpret_cast<const char*>(buffer.data()), buffer.size());
+    bytes += buffer.size();
+    buffer.clear();
+}
+
+bool TraceWriter::close() {
+    flush();
+    uint64_t count = records;
+    out.seekp(8);
+    out.write(reinterpret_cast<const char*>(&count), 8);
+    out.close();
+    return !out.fail();
+}
+
+size_t TraceWriter::getRecords() const {
+    return records;
+}
+
+size_t TraceWriter::getBytes() const {
+    return bytes + buffer.size();
+}
+
+// ================= Reader =================
+TraceReader::TraceReader()
+    : base(nullptr),
+      length(0),
+      cursor(nullptr),
+      end(nullptr),
+      encoding(TraceEncoding::FIXED),
+      records(0),
+      previous{},
+      corrupted(false)
+{
+}
+
+TraceReader::~TraceReader() {
+    unmap();
+}
+
+void TraceReader::unmap() {
+    if (base)
+        munmap(const_cast<uint8_t*>(base), length);
+    base = cursor = end = nullptr;
+    length = 0;
+}
+
+bool TraceReader::open(const std::string& path) {
+    unmap();
+    corrupted = false;
+    std::fill(previous, previous + 16, 0);
+
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        std::cout << "Error: cannot open " << path << "\n";
+        return false;
+    }
+
+    struct stat info;
+    if (fstat(fd, &info) != 0 ||
+        static_cast<size_t>(info.st_size) < HEADER_BYTES) {
+        ::close(fd);
+        std::cout << "Error: " << path << " is not a memsim trace\n";
+        return false;
+    }
+
+    length = static_cast<size_t>(info.st_size);
+    void* mapped = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (mapped == MAP_FAILED) {
+        length = 0;
+        std::cout << "Error: cannot map " << path << "\n";
+        return false;
+    }
+    base = static_cast<const uint8_t*>(mapped);
+    // one front-to-back pass
+    madvise(mapped, length, MADV_SEQUENTIAL);
+
+    if (!std::equal(MAGIC, MAGIC + 4, base) || base[4] != VERSION ||
+        base[5] > static_cast<uint8_t>(TraceEncoding::DELTA)) {
+        unmap();
+        std::cout << "Error: " << path << " is not a memsim trace\n";
+        return false;
+    }
+
+    encoding = static_cast<TraceEncoding>(base[5]);
+    std::memcpy(&records, base + 8, 8);
+    cursor = base + HEADER_BYTES;
+    end = base + length;
+    return true;
+}
+
+bool TraceReader::nextDelta(TraceRecord& record) {
+    uint8_t op = *cursor++;
+    uint64_t value = 0;
+    for (unsigned shift = 0;; shift += 7) {
+        if (cursor == end || shift > 63)
+            return corrupt();
+        uint8_t byte = *cursor++;
+        value |= static_cast<uint64_t>(byte & 0x7f) << shift;
+        if (!(byte & 0x80))
+            break;
+    }
+    if (!isKnownOp(op))
+        return corrupt();
+
+    int64_t delta = static_cast<int64_t>(value >> 1) ^
+                    -static_cast<int64_t>(value & 1);
+    uint64_t& last = previous[streamOf(static_cast<TraceOp>(op))];
+    last += static_cast<uint64_t>(delta);
+
+    record.op = static_cast<TraceOp>(op);
+    record.arg = last;
+    if (!validArg(record.op, record.arg))
+        return corrupt();
+    return true;
+}
+
+bool TraceReader::corrupt() {
+    corrupted = true;
+    cursor = end;
+    return false;
+}
+
+bool TraceReader::isCorrupt() const {
+    return corrupted;
+}
+
+uint64_t TraceReader::getRecords() const {
+    return records;
+}
+
+TraceEncoding TraceReader::getEncoding() const {
+    return encoding;
+}
+
+// ================= Script Conversion =================
+static bool parseNumber(const std::string& text, uint64_t& value) {
+    std::stringstream parse(text);
+    if (text.compare(0, 2, "0x") == 0 || text.compare(0, 2, "0X") == 0)
+        parse.ignore(2) >> std::hex;
+    return !text.empty() && text[0] != '-' &&
+           static_cast<bool>(parse >> value);
+}
+
+bool convertScript(const std::string& scriptPath,
+                   const std::string& tracePath,
+                   TraceEncoding encoding) {
+    std::ifstream in(scriptPath);
+    if (!in) {
+        std::cout << "Error: cannot open " << scriptPath << "\n";
+        return false;
+    }
+
+    TraceWriter writer;
+    if (!writer.open(tracePath, encoding))
+        return false;
+
+    std::string line;
+    size_t lineNo = 0;
+    size_t skipped = 0;
+
+    while (std::getline(in, line)) {
+        lineNo++;
+        std::stringstream ss(line);
+        std::string cmd, first, second;
+        if (!(ss >> cmd))
+            continue;
+        ss >> first >> second;
+
+        uint64_t arg = 0;
+        bool ok = true;
+        TraceOp op;
+
+        if (cmd == "malloc" || cmd == "free" ||
+            cmd == "read" || cmd == "write") {
+            op = cmd == "malloc" ? TraceOp::MALLOC
+               : cmd == "free"   ? TraceOp::FREE
+               : cmd == "read"   ? TraceOp::READ
+               :                   TraceOp::WRITE;
+            ok = parseNumber(first, arg);
+        }
+        else if (cmd == "init" && first == "vm") {
+            // init vm <page> <phys>: both powers of two, stored as log2
+            uint64_t phys = 0;
+            std::string third;
+            ss >> third;
+            ok = parseNumber(second, arg) && parseNumber(third, phys) &&
+                 isPowerOfTwo(arg) && isPowerOfTwo(phys);
+            op = TraceOp::INIT_VM;
+            if (ok)
+                arg = static_cast<uint64_t>(__builtin_ctzll(arg)) |
+                      static_cast<uint64_t>(__builtin_ctzll(phys)) << 8;
+        }
+        else if (cmd == "init" &&
+                 (first == "memory" || first == "buddy" || first == "slab")) {
+            op = first == "memory" ? TraceOp::INIT_MEMORY
+               : first == "buddy"  ? TraceOp::INIT_BUDDY
+               :                     TraceOp::INIT_SLAB;
+            ok = parseNumber(second, arg);
+        }
+        else if (cmd == "set" && first == "allocator") {
+            op = TraceOp::SET_ALLOCATOR;
+            if (second == "first_fit")
+                arg = static_cast<uint64_t>(AllocatorType::FIRST_FIT);
+            else if (second == "best_fit")
+                arg = static_cast<uint64_t>(AllocatorType::BEST_FIT);
+            else if (second == "worst_fit")
+                arg = static_cast<uint64_t>(AllocatorType::WORST_FIT);
+            else if (second == "tlsf")
+                arg = static_cast<uint64_t>(AllocatorType::TLSF);
+            else
+                ok = false;
+        }
+        else {
+            // no record for this command
+            skipped++;
+            continue;
+        }
+
+        if (!ok || arg > TraceWriter::MAX_ARG) {
+            // the command would only print an error
+            std::cout << scriptPath << ":" << lineNo << ": skipped \""
+                      << line << "\" (no valid record)\n";
+            skipped++;
+            continue;
+        }
+        writer.append(op, arg);
+    }
+
+    if (!writer.close()) {
+        std::cout << "Error: cannot write " << tracePath << "\n";
+        return false;
+    }
+
+    std::cout << "Converted " << writer.getRecords() << " commands to "
+              << tracePath << " (" << writer.getBytes() << " bytes, "
+              << (encoding == TraceEncoding::DELTA ? "delta" : "fixed")
+              << " encoding); " << skipped << " skipped\n";
+    return true;
+}
@@ -0,0 +1,259 @@
+#include "../../include/virtual_memory/page_table.h"
+#include <cstring>
+
+// ---------- Constructor ----------
+PageTable::PageTable() {
+    reset(12);
+}
+
+void PageTable::reset(size_t pageShift) {
+    size_t vpnBits = VA_BITS - pageShift;
+    levels = (vpnBits + LEVEL_BITS - 1) / LEVEL_BITS;
+    topBits = vpnBits - LEVEL_BITS * (levels - 1);
+
+    chunks.clear();
+    poolSize = 0;
+    freeNodes.clear();
+    liveNodes = 0;
+    mappedPages = 0;
+    newNode();
+}
+
+// ---------- Helpers ----------
+size_t PageTable::indexAt(size_t vpn, size_t level) const {
+    size_t shift = LEVEL_BITS * (levels - 1 - level);
+    size_t bits = level == 0 ? topBits : LEVEL_BITS;
+    return (vpn >> shift) & ((static_cast<size_t>(1) << bits) - 1);
+}
+
+size_t PageTable::levelOrder(size_t level) const {
+    return LEVEL_BITS * (levels - 1 - level);
+}
+
+bool PageTable::supportsOrder(size_t order) const {
+    // the root never holds a leaf
+    return order > 0 && order % LEVEL_BITS == 0 &&
+           order / LEVEL_BITS + 1 < levels;
+}
+
+uint32_t PageTable::newNode() {
+    uint32_t index;
+    if (!freeNodes.empty()) {
+        index = freeNodes.back();
+        freeNodes.pop_back();
+    } else {
+        if (poolSize == chunks.size() * CHUNK_NODES)
+            chunks.emplace_back(new Node[CHUNK_NODES]);
+        index = static_cast<uint32_t>(poolSize++);
+    }
+
+    Node& fresh = node(index);
+    std::memset(fresh.entries, 0, sizeof(fresh.entries));
+    fresh.live = 0;
+    liveNodes++;
+    return index;
+}
+
+// ---------- Walk ----------
+uint64_t* PageTable::find(size_t vpn) {
+    size_t reads = 0;
+    return find(vpn, reads);
+}
+
+uint64_t* PageTable::find(size_t vpn, size_t& reads) {
+    size_t order;
+    return find(vpn, reads, order);
+}
+
+uint64_t* PageTable::find(size_t vpn, size_t& reads, size_t& order) {
+    Node* current = &node(0);
+    for (size_t level = 0; level + 1 < levels; level++) {
+        uint64_t& entry = current->entries[indexAt(vpn, level)];
+        reads++;
+        if (!(entry & PRESENT))
+            return nullptr;
+        if (entry & HUGE) {
+            order = levelOrder(level);
+            return &entry;
+        }
+        current = &node(static_cast<uint32_t>(entryFrame(entry)));
+    }
+    reads++;
+    order = 0;
+    return &current->entries[indexAt(vpn, levels - 1)];
+}
+
+uint64_t& PageTable::map(size_t vpn) {
+    Node* current = &node(0);
+    for (size_t level = 0; level + 1 < levels; level++) {
+        uint64_t& entry = current->entries[indexAt(vpn, level)];
+
+        if (!(entry & PRESENT)) {
+            uint32_t child = newNode();
+            entry = makeEntry(child, PRESENT);
+            current->live++;
+            current = &node(child);
+        } else {
+            current = &node(static_cast<uint32_t>(entryFrame(entry)));
+        }
+    }
+
+    uint64_t& leaf = current->entries[indexAt(vpn, levels - 1)];
+    if (!(leaf & PRESENT)) {
+        current->live++;
+        mappedPages++;
+        leaf = PRESENT;
+    }
+    return leaf;
+}
+
+uint64_t& PageTable::mapHuge(size_t vpn, size_t order) {
+    const size_t slot = levels - 1 - order / LEVEL_BITS;
+    Node* current = &node(0);
+    for (size_t level = 0; level < slot; level++) {
+        uint64_t& entry = current->entries[indexAt(vpn, level)];
+
+        if (!(entry & PRESENT)) {
+            uint32_t child = newNode();
+            entry = makeEntry(child, PRESENT);
+            current->live++;
+            current = &node(child);
+        } else {
+            current = &node(static_cast<uint32_t>(entryFrame(entry)));
+        }
+    }
+
+    uint64_t& leaf = current->entries[indexAt(vpn, slot)];
+    if (!(leaf & PRESENT)) {
+        current->live++;
+        mappedPages += static_cast<size_t>(1) << order;
+        leaf = PRESENT | HUGE;
+    }
+    return leaf;
+}
+
+void PageTable::unmap(size_t vpn) {
+    // path[level] = node visited at that level
+    uint32_t path[VA_BITS / LEVEL_BITS + 1];
+    uint32_t current = 0;
+    size_t level = 0;
+    for (;; level++) {
+        path[level] = current;
+        uint64_t entry = node(current).entries[indexAt(vpn, level)];
+        if (!(entry & PRESENT))
+            return;
+        if (level + 1 == levels || (entry & HUGE))
+            break;
+        current = static_cast<uint32_t>(entryFrame(entry));
+    }
+
+    node(current).entries[indexAt(vpn, level)] = 0;
+    mappedPages -= static_cast<size_t>(1) << levelOrder(level);
+
+    // free emptied nodes bottom-up; the root always stays
+    for (; level > 0; level--) {
+        if (--node(path[level]).live > 0)
+            return;
+        freeNodes.push_back(path[level]);
+        liveNodes--;
+        node(path[level - 1]).entries[indexAt(vpn, level - 1)] = 0;
+    }
+    node(0).live--;
+}
+
+uint64_t* PageTable::split(size_t vpn) {
+    size_t reads = 0;
+    size_t order = 0;
+    uint64_t* entry = find(vpn, reads, order);
+    if (!entry || order == 0)
+        return nullptr;
+
+    // the child covers the same pages one level down
+    const size_t step = static_cast<size_t>(1) << (order - LEVEL_BITS);
+    const uint64_t flags = (*entry & (PRESENT | ACCESSED | DIRTY)) |
+                           (order > LEVEL_BITS ? HUGE : 0);
+    const size_t head = entryFrame(*entry);
+
+    uint32_t child = newNode();
+    Node& fresh = node(child);
+    for (size_t i = 0; i < FANOUT; i++)
+        fresh.entries[i] = makeEntry(head + i * step, flags);
+    fresh.live = FANOUT;
+
+    *entry = makeEntry(child, PRESENT);
+    return fresh.entries;
+}
+
+// ---------- Regions ----------
+void PageTable::collectNode(uint32_t index, size_t level, size_t base,
+                            std::vector<Mapping>& out) {
+    const size_t order = levelOrder(level);
+    for (size_t i = 0; i < FANOUT; i++) {
+        uint64_t entry = node(index).entries[i];
+        if (!(entry & PRESENT))
+            continue;
+
+        size_t vpn = base + (i << order);
+        if (level + 1 == levels || (entry & HUGE))
+            out.push_back(Mapping{vpn, entry, order});
+        else
+            collectNode(static_cast<uint32_t>(entryFrame(entry)),
+                        level + 1, vpn, out);
+    }
+}
+
+void PageTable::collect(size_t vpn, size_t order, std::vector<Mapping>& out) {
+    const size_t slot = levels - 1 - order / LEVEL_BITS;
+    const size_t base = vpn & ~((static_cast<size_t>(1) << order) - 1);
+
+    Node* current = &node(0);
+    for (size_t level = 0; level < slot; level++) {
+        uint64_t entry = current->entries[indexAt(vpn, level)];
+        if (!(entry & PRESENT))
+            return;
+        if (entry & HUGE) {
+            // a larger page covers the whole region
+            const size_t above = levelOrder(level);
+            out.push_back(Mapping{
+                vpn & ~((static_cast<size_t>(1) << above) - 1), entry, above});
+            return;
+        }
+        current = &node(static_cast<uint32_t>(entryFrame(entry)));
+    }
+
+    uint64_t entry = current->entries[indexAt(vpn, slot)];
+    if (!(entry & PRESENT))
+        return;
+    if (entry & HUGE)
+        out.push_back(Mapping{base, entry, order});
+    else
+        collectNode(static_cast<uint32_t>(entryFrame(entry)), slot + 1,
+                    base, out);
+}
+
+size_t PageTable::populated(size_t vpn, size_t order) {
+    const size_t slot = levels - 1 - order / LEVEL_BITS;
+    Node* current = &node(0);
+    for (size_t level = 0; level <= slot; level++) {
+        uint64_t entry = current->entries[indexAt(vpn, level)];
+        if (!(entry & PRESENT))
+            return 0;
+        if (entry & HUGE)
+            return FANOUT;
+        current = &node(static_cast<uint32_t>(entryFrame(entry)));
+    }
+    return current->live;
+}
+
+// ---------- Getters ----------
+size_t PageTable::getLevels() const {
+    return levels;
+}
+
+size_t PageTable::getNodes() const {
+    return liveNodes;
+}
+
+size_t PageTable::getMappedPages() const {
+    return mappedPages;
+}
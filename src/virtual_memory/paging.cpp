@@ -0,0 +1,191 @@
+#include "../../include/virtual_memory/paging.h"
+#include "../../include/virtual_memory/vm.h"
+#include <algorithm>
+#include <cctype>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <set>
+#include <sstream>
+#include <unordered_map>
+#include <utility>
+
+// ================= Page Replacement Policy =================
+bool parsePageReplacement(const std::string& text, PageReplacement& out) {
+    std::string lower = text;
+    std::transform(lower.begin(), lower.end(), lower.begin(),
+                   [](unsigned char c) { return std::tolower(c); });
+
+    if (lower == "fifo")            out = PageReplacement::FIFO;
+    else if (lower == "lru")        out = PageReplacement::LRU;
+    else if (lower == "clock")      out = PageReplacement::CLOCK;
+    else if (lower == "wsclock")    out = PageReplacement::WSCLOCK;
+    else return false;
+    return true;
+}
+
+const char* pageReplacementName(PageReplacement policy) {
+    switch (policy) {
+    case PageReplacement::FIFO:     return "FIFO";
+    case PageReplacement::LRU:      return "LRU";
+    case PageReplacement::CLOCK:    return "CLOCK";
+    case PageReplacement::WSCLOCK:  return "WSCLOCK";
+    }
+    return "?";
+}
+
+// ================= Trace Loading =================
+bool loadPageTrace(const std::string& path, std::vector<PageRef>& refs) {
+    std::ifstream in(path);
+    if (!in) {
+        std::cout << "Error: cannot open " << path << "\n";
+        return false;
+    }
+
+    refs.clear();
+    std::string line;
+    size_t lineNo = 0;
+
+    while (std::getline(in, line)) {
+        lineNo++;
+        line = line.substr(0, line.find('#'));
+
+        std::stringstream ss(line);
+        std::string op, text;
+        if (!(ss >> op))
+            continue;
+
+        ss >> text;
+        size_t addr = 0;
+        std::stringstream parse(text);
+        if (text.compare(0, 2, "0x") == 0 || text.compare(0, 2, "0X") == 0)
+            parse.ignore(2) >> std::hex;
+
+        bool write = (op == "w" || op == "W");
+        if (!(parse >> addr) || (!write && op != "r" && op != "R") ||
+            (addr >> PageTable::VA_BITS) != 0) {
+            std::cout << path << ":" << lineNo
+                      << ": expected <r|w> <48-bit address>\n";
+            return false;
+        }
+        refs.push_back(PageRef{addr, write});
+    }
+
+    if (refs.empty()) {
+        std::cout << "Error: " << path << " has no references\n";
+        return false;
+    }
+    return true;
+}
+
+// ================= Offline Optimal (Belady) =================
+OptResult simulateOpt(const std::vector<PageRef>& refs,
+                      size_t pageSize,
+                      size_t frames) {
+    OptResult result{0, 0, 0};
+    const size_t n = refs.size();
+    const size_t NEVER = n;     // past every reference
+
+    // ---------- Next-use index (one backward pass) ----------
+    std::vector<size_t> nextUse(n);
+    std::unordered_map<size_t, size_t> upcoming;   // page -> next reference
+    upcoming.reserve(n);
+    for (size_t i = n; i-- > 0;) {
+        size_t page = refs[i].addr / pageSize;
+        auto found = upcoming.find(page);
+        nextUse[i] = found == upcoming.end() ? NEVER : found->second;
+        upcoming[page] = i;
+    }
+
+    // ---------- Replay ----------
+    struct Resident {
+        size_t nextUse;
+        bool dirty;
+    };
+    std::unordered_map<size_t, Resident> resident;
+    // (next use, page), furthest last; pages never used again tie on
+    // NEVER and are told apart by page number
+    std::set<std::pair<size_t, size_t>> byNextUse;
+
+    for (size_t i = 0; i < n; i++) {
+        size_t page = refs[i].addr / pageSize;
+        auto found = resident.find(page);
+
+        if (found != resident.end()) {
+            byNextUse.erase({found->second.nextUse, page});
+        } else {
+            result.faults++;
+            if (resident.size() == frames) {
+                auto furthest = std::prev(byNextUse.end());
+                size_t victim = furthest->second;
+                byNextUse.erase(furthest);
+
+                auto gone = resident.find(victim);
+                if (gone->second.dirty)
+                    result.dirtyEvictions++;
+                result.evictions++;
+                resident.erase(gone);
+            }
+            found = resident.emplace(page, Resident{0, false}).first;
+        }
+
+        found->second.nextUse = nextUse[i];
+        found->second.dirty |= refs[i].write;
+        byNextUse.insert({nextUse[i], page});
+    }
+    return result;
+}
+
+// ================= Policy Comparison =================
+void comparePaging(const std::vector<PageRef>& refs,
+                   size_t pageSize,
+                   size_t physSize,
+                   size_t tau) {
+    const PageReplacement policies[] = {
+        PageReplacement::FIFO,
+        PageReplacement::LRU,
+        PageReplacement::CLOCK,
+        PageReplacement::WSCLOCK
+    };
+
+    std::cout << std::dec;
+    std::cout << "Paging comparison: " << refs.size() << " references, "
+              << physSize / pageSize << " frames of " << pageSize
+              << " bytes\n";
+    std::cout << std::left << std::setw(10) << "Policy"
+              << std::right << std::setw(10) << "Faults"
+              << std::setw(12) << "Fault rate"
+              << std::setw(11) << "Evictions"
+              << std::setw(12) << "Writebacks" << "\n";
+
+    auto row = [&](const std::string& name, size_t faults,
+                   size_t evictions, size_t writebacks) {
+        double rate = (double)faults / refs.size() * 100.0;
+        std::cout << std::left << std::setw(10) << name
+                  << std::right << std::setw(10) << faults
+                  << std::setw(11) << std::fixed << std::setprecision(2)
+                  << rate << "%" << std::defaultfloat
+                  << std::setprecision(6)
+                  << std::setw(11) << evictions
+                  << std::setw(12) << writebacks << "\n";
+    };
+
+    for (PageReplacement policy : policies) {
+        VirtualMemory vm;
+        vm.init(pageSize, physSize);
+        vm.setReplacement(policy, tau);
+
+        TranslateInfo info;
+        for (const PageRef& ref : refs)
+            vm.translate(ref.addr, ref.write, info);
+
+        std::string name = pageReplacementName(policy);
+        if (policy == PageReplacement::WSCLOCK)
+            name += "/" + std::to_string(tau);
+        row(name, vm.getPageFaults(), vm.getEvictions(),
+            vm.getDirtyEvictions() + vm.getCleanings());
+    }
+
+    OptResult opt = simulateOpt(refs, pageSize, physSize / pageSize);
+    row("OPT", opt.faults, opt.evictions, opt.dirtyEvictions);
+}
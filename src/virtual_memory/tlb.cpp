@@ -0,0 +1,196 @@
+#include "../../include/virtual_memory/tlb.h"
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+
+// ---------- Constructor ----------
+static ReplacementPolicy decodePolicy(const std::string& name) {
+    ReplacementPolicy policy = ReplacementPolicy::LRU;
+    parseReplacementPolicy(name, policy);
+    return policy;
+}
+
+Tlb::Tlb(const TlbConfig& cfg)
+    : config(cfg),
+      vpns(cfg.sets * cfg.ways, 0),
+      asids(cfg.sets * cfg.ways, 0),
+      frames(cfg.sets * cfg.ways, 0),
+      valid(cfg.sets * cfg.ways, 0),
+      dirty(cfg.sets * cfg.ways, 0),
+      replacement(decodePolicy(cfg.policy), cfg.sets, cfg.ways, cfg.seed),
+      accesses(0),
+      hits(0),
+      misses(0),
+      evictions(0),
+      flushes(0),
+      hugeHits(0)
+{
+}
+
+// ---------- Helpers ----------
+// vpn >> order with the order above the 48 VPN bits, so entries of
+// different page sizes never match each other
+static size_t tagOf(size_t vpn, size_t order) {
+    return (vpn >> order) | (order << 48);
+}
+
+int Tlb::findWay(size_t base, uint16_t asid, size_t tag) const {
+    for (size_t w = 0; w < config.ways; w++) {
+        if (vpns[base + w] == tag && asids[base + w] == asid && valid[base + w])
+            return static_cast<int>(w);
+    }
+    return -1;
+}
+
+// ---------- Lookup / Insert ----------
+bool Tlb::lookup(uint16_t asid, size_t vpn, size_t& frame, bool& isDirty) {
+    size_t order;
+    return lookup(asid, vpn, 1, frame, isDirty, order);
+}
+
+bool Tlb::lookup(uint16_t asid, size_t vpn, uint32_t probe,
+                 size_t& frame, bool& isDirty, size_t& order) {
+    accesses++;
+
+    for (; probe != 0; probe &= probe - 1) {
+        size_t k = __builtin_ctz(probe);
+        size_t set = (vpn >> k) % config.sets;
+        size_t base = set * config.ways;
+        int way = findWay(base, asid, tagOf(vpn, k));
+        if (way < 0)
+            continue;
+
+        hits++;
+        if (k > 0)
+            hugeHits++;
+        replacement.onHit(set, way);
+        frame = frames[base + way];
+        isDirty = dirty[base + way];
+        order = k;
+        return true;
+    }
+
+    misses++;
+    return false;
+}
+
+void Tlb::insert(uint16_t asid, size_t vpn, size_t frame, bool isDirty,
+                 size_t order) {
+    size_t tag = tagOf(vpn, order);
+    size_t set = (vpn >> order) % config.sets;
+    size_t base = set * config.ways;
+
+    int way = findWay(base, asid, tag);
+    if (way >= 0) {
+        // refreshed translation (e.g. the dirty bit was just set)
+        frames[base + way] = frame;
+        dirty[base + way] = isDirty;
+        return;
+    }
+
+    const void* empty = std::memchr(valid.data() + base, 0, config.ways);
+    if (empty) {
+        way = static_cast<int>(
+            static_cast<const uint8_t*>(empty) - (valid.data() + base));
+    } else {
+        way = static_cast<int>(replacement.victim(set));
+        evictions++;
+    }
+
+    vpns[base + way] = tag;
+    asids[base + way] = asid;
+    frames[base + way] = frame;
+    valid[base + way] = 1;
+    dirty[base + way] = isDirty;
+    replacement.onFill(set, way);
+}
+
+// ---------- Invalidation ----------
+bool Tlb::invalidate(uint16_t asid, size_t vpn, size_t order) {
+    size_t base = ((vpn >> order) % config.sets) * config.ways;
+    int way = findWay(base, asid, tagOf(vpn, order));
+    if (way < 0)
+        return false;
+
+    valid[base + way] = 0;
+    return true;
+}
+
+void Tlb::flush() {
+    std::fill(valid.begin(), valid.end(), 0);
+    flushes++;
+}
+
+void Tlb::flushAsid(uint16_t asid) {
+    for (size_t i = 0; i < valid.size(); i++) {
+        if (asids[i] == asid)
+            valid[i] = 0;
+    }
+    flushes++;
+}
+
+void Tlb::reset() {
+    std::fill(valid.begin(), valid.end(), 0);
+    std::fill(dirty.begin(), dirty.end(), 0);
+    replacement.reset();
+    accesses = hits = misses = evictions = flushes = hugeHits = 0;
+}
+
+// ---------- Stats ----------
+void Tlb::stats(size_t pageSize) const {
+    double hitRate = (accesses == 0)
+        ? 0.0
+        : (double)hits / accesses * 100.0;
+    double missRate = (accesses == 0)
+        ? 0.0
+        : (double)misses / accesses * 100.0;
+
+    std::cout << std::dec;
+    std::cout << "TLB Stats (" << config.name << ")\n";
+    std::cout << "Geometry : " << config.sets << " sets x " << config.ways
+              << " ways, "
+              << replacementPolicyName(replacement.getPolicy()) << "\n";
+    std::cout << "Reach    : " << getEntries() * pageSize
+              << " bytes in base pages, "
+              << getCurrentReach(pageSize) << " bytes now\n";
+    std::cout << "Accesses : " << accesses << "\n";
+    std::cout << "Hits     : " << hits;
+    if (hugeHits > 0)
+        std::cout << " (" << hugeHits << " on huge pages)";
+    std::cout << "\n";
+    std::cout << "Misses   : " << misses << "\n";
+    std::cout << "Evictions: " << evictions << "\n";
+    std::cout << "Flushes  : " << flushes << "\n";
+    std::cout << "Hit Rate : " << hitRate << "%\n";
+    std::cout << "Miss Rate: " << missRate << "%\n";
+}
+
+// ---------- Getters ----------
+const std::string& Tlb::getName() const {
+    return config.name;
+}
+
+size_t Tlb::getEntries() const {
+    return config.sets * config.ways;
+}
+
+size_t Tlb::getCurrentReach(size_t pageSize) const {
+    size_t reach = 0;
+    for (size_t i = 0; i < valid.size(); i++) {
+        if (valid[i])
+            reach += pageSize << (vpns[i] >> 48);
+    }
+    return reach;
+}
+
+size_t Tlb::getAccesses() const {
+    return accesses;
+}
+
+size_t Tlb::getHits() const {
+    return hits;
+}
+
+size_t Tlb::getMisses() const {
+    return misses;
+}
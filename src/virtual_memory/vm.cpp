@@ -1,39 +1,724 @@
 #include "../../include/virtual_memory/vm.h"
+#include <algorithm>
+#include <cctype>
 #include <iostream>
 
-VirtualMemory::VirtualMemory(size_t pSize, size_t physSize)
-    : pageSize(pSize),
+// ---------- helper ----------
+static bool isPowerOfTwo(size_t x) {
+    return x && !(x & (x - 1));
+}
+
+// "2M", "1G", ... for a power-of-two size
+static std::string sizeLabel(size_t bytes) {
+    const char* units[] = {"", "K", "M", "G", "T"};
+    size_t unit = 0;
+    while (unit < 4 && bytes >= 1024 && bytes % 1024 == 0) {
+        bytes /= 1024;
+        unit++;
+    }
+    return std::to_string(bytes) + units[unit];
+}
+
+static size_t orderMask(size_t order) {
+    return (static_cast<size_t>(1) << order) - 1;
+}
+
+// ================= Huge Page Mode =================
+bool parseHugePageMode(const std::string& text, HugePageMode& out) {
+    std::string lower = text;
+    std::transform(lower.begin(), lower.end(), lower.begin(),
+                   [](unsigned char c) { return std::tolower(c); });
+
+    if (lower == "off")             out = HugePageMode::OFF;
+    else if (lower == "fault")      out = HugePageMode::FAULT;
+    else if (lower == "promote")    out = HugePageMode::PROMOTE;
+    else return false;
+    return true;
+}
+
+const char* hugePageModeName(HugePageMode mode) {
+    switch (mode) {
+    case HugePageMode::OFF:         return "off";
+    case HugePageMode::FAULT:       return "fault";
+    case HugePageMode::PROMOTE:     return "promote";
+    }
+    return "?";
+}
+
+// assign() takes it by reference
+const uint32_t VirtualMemory::NO_FRAME;
+
+// ---------- Constructor ----------
+VirtualMemory::VirtualMemory()
+    : pageSize(0),
+      pageShift(0),
+      numFrames(0),
+      asid(0),
+      table(nullptr),
+      usedFrames(0),
+      replacement(PageReplacement::FIFO),
+      tau(1000),
+      newest(NO_FRAME),
+      oldest(NO_FRAME),
+      hand(0),
+      hugeMode(HugePageMode::OFF),
+      hugeMapped{0, 0},
+      translations(0),
+      hits(0),
       pageFaults(0),
-      hits(0)
+      evictions(0),
+      dirtyEvictions(0),
+      cleanings(0),
+      walks(0),
+      walkReads(0),
+      dirtyAssists(0),
+      shootdowns(0),
+      hugeFaults(0),
+      hugeFallbacks(0),
+      promotions(0),
+      promotionFailures(0),
+      pagesCopied(0),
+      demotions(0),
+      walkReadsSaved(0)
 {
+}
+
+// ---------- Init ----------
+bool VirtualMemory::init(size_t pSize, size_t physSize) {
+    if (!isPowerOfTwo(pSize) || !isPowerOfTwo(physSize) || physSize < pSize) {
+        std::cout << "Error: page size and physical memory must be powers "
+                     "of two, with physical memory >= page size\n";
+        return false;
+    }
+    if (__builtin_ctzll(pSize) >= static_cast<int>(PageTable::VA_BITS)) {
+        std::cout << "Error: page size too large\n";
+        return false;
+    }
+    if (physSize / pSize > MAX_FRAMES) {
+        std::cout << "Error: physical memory is limited to " << MAX_FRAMES
+                  << " frames\n";
+        return false;
+    }
+
+    pageSize = pSize;
+    pageShift = __builtin_ctzll(pSize);
     numFrames = physSize / pageSize;
+
+    tables.clear();
+    asid = 0;
+    table = &tables[asid];
+    table->reset(pageShift);
+
+    frames.reset(numFrames);
+    usedFrames = 0;
+
+    owner.assign(numFrames, MappedPage{0, 0, 0});
+    pte.assign(numFrames, nullptr);
+    prevFrame.assign(numFrames, NO_FRAME);
+    nextFrame.assign(numFrames, NO_FRAME);
+    newest = oldest = NO_FRAME;
+    hand = 0;
+    lastUse.assign(numFrames, 0);
+
+    for (Tlb& tlb : tlbs)
+        tlb.reset();
+
+    translations = hits = pageFaults = 0;
+    evictions = dirtyEvictions = cleanings = 0;
+    walks = walkReads = dirtyAssists = shootdowns = 0;
+    std::fill(hugeMapped, hugeMapped + HUGE_ORDERS, 0);
+    hugeFaults = hugeFallbacks = 0;
+    promotions = promotionFailures = pagesCopied = demotions = 0;
+    walkReadsSaved = 0;
+    return true;
 }
 
-size_t VirtualMemory::translate(size_t vAddr) {
-    size_t page = vAddr / pageSize;
-    size_t offset = vAddr % pageSize;
+bool VirtualMemory::isInitialized() const {
+    return pageSize != 0;
+}
+
+// ---------- Address spaces ----------
+bool VirtualMemory::setAsid(size_t id) {
+    if (!isInitialized() || id > Tlb::MAX_ASID)
+        return false;
+
+    asid = static_cast<uint16_t>(id);
+    auto found = tables.find(asid);
+    if (found == tables.end()) {
+        table = &tables[asid];
+        table->reset(pageShift);
+    } else {
+        table = &found->second;
+    }
+    return true;
+}
+
+uint16_t VirtualMemory::getAsid() const {
+    return asid;
+}
+
+// ---------- Replacement ----------
+void VirtualMemory::setReplacement(PageReplacement policy, size_t window) {
+    replacement = policy;
+    tau = window;
+}
+
+PageReplacement VirtualMemory::getReplacement() const {
+    return replacement;
+}
+
+size_t VirtualMemory::getTau() const {
+    return tau;
+}
+
+void VirtualMemory::linkNewest(size_t frame) {
+    prevFrame[frame] = NO_FRAME;
+    nextFrame[frame] = newest;
+    if (newest != NO_FRAME)
+        prevFrame[newest] = static_cast<uint32_t>(frame);
+    else
+        oldest = static_cast<uint32_t>(frame);
+    newest = static_cast<uint32_t>(frame);
+}
 
-    if (pageTable.count(page)) {
+void VirtualMemory::unlink(size_t frame) {
+    uint32_t prev = prevFrame[frame];
+    uint32_t next = nextFrame[frame];
+
+    if (prev != NO_FRAME)
+        nextFrame[prev] = next;
+    else
+        newest = next;
+
+    if (next != NO_FRAME)
+        prevFrame[next] = prev;
+    else
+        oldest = prev;
+}
+
+void VirtualMemory::shootdown(const MappedPage& page) {
+    for (Tlb& tlb : tlbs) {
+        if (tlb.invalidate(page.asid, page.vpn, page.order))
+            shootdowns++;
+    }
+}
+
+// frame to evict; every frame is in use
+size_t VirtualMemory::chooseVictim() {
+    if (replacement == PageReplacement::FIFO ||
+        replacement == PageReplacement::LRU)
+        return oldest;
+
+    const uint64_t now = translations;
+    size_t fallback = NO_FRAME;   // WSCLOCK: first unreferenced page seen
+
+    // CLOCK ends within one sweep (the first sweep clears every A bit);
+    // WSCLOCK may need a second one to reach pages it cleaned
+    for (size_t step = 0; step < 2 * numFrames; step++) {
+        size_t frame = hand;
+        hand = (hand + 1) % numFrames;
+
+        uint64_t* entry = pte[frame];
+        if (!entry)
+            continue;
+        // a huge page's tail frames have nothing to look at
+        hand = (frame + (static_cast<size_t>(1) << owner[frame].order)) %
+               numFrames;
+
+        if (*entry & PageTable::ACCESSED) {
+            // second chance
+            *entry &= ~PageTable::ACCESSED;
+            lastUse[frame] = now;
+            shootdown(owner[frame]);
+            continue;
+        }
+
+        if (replacement == PageReplacement::CLOCK)
+            return frame;
+
+        // ---------- WSCLOCK ----------
+        if (fallback == NO_FRAME)
+            fallback = frame;
+        if (now - lastUse[frame] <= tau)
+            continue;                 // still in the working set
+
+        if (*entry & PageTable::DIRTY) {
+            // schedule the write-back and move on
+            *entry &= ~PageTable::DIRTY;
+            cleanings++;
+            shootdown(owner[frame]);
+            continue;
+        }
+        return frame;
+    }
+    return fallback;
+}
+
+// ---------- TLB ----------
+void VirtualMemory::addTlbLevel(const TlbConfig& config) {
+    tlbs.emplace_back(config);
+}
+
+void VirtualMemory::clearTlb() {
+    tlbs.clear();
+}
+
+void VirtualMemory::flushTlb() {
+    for (Tlb& tlb : tlbs)
+        tlb.flush();
+}
+
+void VirtualMemory::flushTlb(uint16_t id) {
+    for (Tlb& tlb : tlbs)
+        tlb.flushAsid(id);
+}
+
+size_t VirtualMemory::numTlbLevels() const {
+    return tlbs.size();
+}
+
+const Tlb& VirtualMemory::tlbLevel(size_t i) const {
+    return tlbs[i];
+}
+
+// ---------- Frames ----------
+// a block of 2^order frames; order must not exceed the pool's
+size_t VirtualMemory::allocateFrames(size_t order) {
+    const size_t span = static_cast<size_t>(1) << order;
+    size_t frame = frames.allocateOrder(static_cast<int>(order));
+    while (frame == static_cast<size_t>(-1)) {
+        // evicting victims one by one rarely frees a whole block, so
+        // reclaim the aligned region around the policy's victim
+        size_t base = chooseVictim() & ~orderMask(order);
+        for (size_t f = base; f < base + span;) {
+            if (!pte[f]) {
+                f++;
+                continue;
+            }
+            size_t next = f + (static_cast<size_t>(1) << owner[f].order);
+            evict(f);
+            f = next;
+        }
+        frame = frames.allocateOrder(static_cast<int>(order));
+    }
+    usedFrames += span;
+    return frame;
+}
+
+void VirtualMemory::evict(size_t frame) {
+    MappedPage victim = owner[frame];
+
+    if (*pte[frame] & PageTable::DIRTY)
+        dirtyEvictions++;
+    evictions++;
+
+    // no TLB may keep translating to the freed frame
+    shootdown(victim);
+
+    unlink(frame);
+    pte[frame] = nullptr;
+    frames.releaseOrder(frame, static_cast<int>(victim.order));
+    usedFrames -= static_cast<size_t>(1) << victim.order;
+    if (victim.order > 0)
+        hugeMapped[victim.order / PageTable::LEVEL_BITS - 1]--;
+    tables[victim.asid].unmap(victim.vpn);
+}
+
+// records a fresh mapping of the current address space in its frames
+void VirtualMemory::mapFrames(size_t frame, size_t vpn, size_t order,
+                              uint64_t* entry) {
+    owner[frame] = MappedPage{asid, static_cast<uint8_t>(order), vpn};
+    pte[frame] = entry;
+    lastUse[frame] = translations;
+    linkNewest(frame);
+    if (order > 0)
+        hugeMapped[order / PageTable::LEVEL_BITS - 1]++;
+}
+
+// unmaps one mapping of the current address space and frees its frames
+// (no write-back: the caller moves the data)
+void VirtualMemory::dropMapping(const PageTable::Mapping& mapping) {
+    size_t frame = PageTable::entryFrame(mapping.entry);
+    shootdown(owner[frame]);
+    unlink(frame);
+    pte[frame] = nullptr;
+    frames.releaseOrder(frame, static_cast<int>(mapping.order));
+    usedFrames -= static_cast<size_t>(1) << mapping.order;
+    if (mapping.order > 0)
+        hugeMapped[mapping.order / PageTable::LEVEL_BITS - 1]--;
+    table->unmap(mapping.vpn);
+}
+
+// page-table walk in the current address space, counted; `order` is that
+// of the page found
+uint64_t* VirtualMemory::walk(size_t vpn, size_t& order) {
+    walks++;
+    order = 0;
+    uint64_t* entry = table->find(vpn, walkReads, order);
+    // a huge leaf ends the walk early
+    walkReadsSaved += order / PageTable::LEVEL_BITS;
+    return entry;
+}
+
+uint32_t VirtualMemory::probeOrders() const {
+    uint32_t orders = 1;
+    for (size_t i = 0; i < HUGE_ORDERS; i++) {
+        if (hugeMapped[i] > 0)
+            orders |= 1u << (PageTable::LEVEL_BITS * (i + 1));
+    }
+    return orders;
+}
+
+// ---------- Huge pages ----------
+void VirtualMemory::setHugePages(HugePageMode mode) {
+    hugeMode = mode;
+}
+
+HugePageMode VirtualMemory::getHugePages() const {
+    return hugeMode;
+}
+
+// replaces every mapping in the region of `vpn` with one huge page; the
+// block comes first so that, without eviction, a failure changes nothing
+bool VirtualMemory::collapse(size_t vpn, size_t order, bool mayEvict) {
+    size_t block = frames.allocateOrder(static_cast<int>(order));
+    if (block == static_cast<size_t>(-1) && !mayEvict) {
+        promotionFailures++;
+        return false;
+    }
+
+    std::vector<PageTable::Mapping> region;
+    table->collect(vpn, order, region);
+
+    uint64_t flags = PageTable::PRESENT | PageTable::HUGE;
+    for (const PageTable::Mapping& mapping : region) {
+        flags |= mapping.entry & (PageTable::ACCESSED | PageTable::DIRTY);
+        pagesCopied += static_cast<size_t>(1) << mapping.order;
+        dropMapping(mapping);
+    }
+
+    // the region's own frames are free now, so eviction cannot hit it
+    if (block == static_cast<size_t>(-1))
+        block = allocateFrames(order);
+    else
+        usedFrames += static_cast<size_t>(1) << order;
+
+    uint64_t* entry = &table->mapHuge(vpn, order);
+    *entry = PageTable::makeEntry(block, flags);
+    mapFrames(block, vpn & ~orderMask(order), order, entry);
+    promotions++;
+    return true;
+}
+
+bool VirtualMemory::promote(size_t vAddr, size_t bytes) {
+    if (!isInitialized() || (vAddr >> PageTable::VA_BITS) != 0) {
+        std::cout << "Error: address outside the 48-bit virtual address "
+                     "space\n";
+        return false;
+    }
+
+    size_t order = 0;
+    while (order < 64 && (pageSize << order) < bytes)
+        order++;
+    if ((pageSize << order) != bytes || !table->supportsOrder(order)) {
+        std::cout << "Error: huge pages here are "
+                  << sizeLabel(pageSize << PageTable::LEVEL_BITS) << " and "
+                  << sizeLabel(pageSize << (2 * PageTable::LEVEL_BITS))
+                  << "\n";
+        return false;
+    }
+    if (static_cast<int>(order) > frames.getMaxOrder()) {
+        std::cout << "Error: a " << sizeLabel(bytes)
+                  << " page needs more physical memory\n";
+        return false;
+    }
+
+    size_t page = vAddr >> pageShift;
+    size_t reads = 0;
+    size_t covering = 0;
+    uint64_t* entry = table->find(page, reads, covering);
+    if (entry && (*entry & PageTable::PRESENT) && covering >= order) {
+        std::cout << "Error: already mapped by a "
+                  << sizeLabel(pageSize << covering) << " page\n";
+        return false;
+    }
+    return collapse(page, order, true);
+}
+
+bool VirtualMemory::demote(size_t vAddr) {
+    size_t page = vAddr >> pageShift;
+    size_t reads = 0;
+    size_t order = 0;
+    uint64_t* entry = nullptr;
+    if (isInitialized() && (vAddr >> PageTable::VA_BITS) == 0)
+        entry = table->find(page, reads, order);
+    if (!entry || !(*entry & PageTable::PRESENT) || order == 0) {
+        std::cout << "Error: address not on a huge page\n";
+        return false;
+    }
+
+    const size_t head = PageTable::entryFrame(*entry);
+    const MappedPage huge = owner[head];
+    const uint64_t seen = lastUse[head];
+
+    shootdown(huge);
+    unlink(head);
+    hugeMapped[order / PageTable::LEVEL_BITS - 1]--;
+
+    // the block's frames stay put; each piece becomes its own page
+    uint64_t* children = table->split(page);
+    const size_t sub = order - PageTable::LEVEL_BITS;
+    const size_t step = static_cast<size_t>(1) << sub;
+    for (size_t i = 0; i < PageTable::FANOUT; i++) {
+        size_t frame = head + i * step;
+        mapFrames(frame, huge.vpn + i * step, sub, &children[i]);
+        lastUse[frame] = seen;
+    }
+    demotions++;
+    return true;
+}
+
+// ---------- Translate ----------
+size_t VirtualMemory::translate(size_t vAddr, bool write,
+                                TranslateInfo& info) {
+    info.tlbLevel = -1;
+    info.fault = false;
+    if (!isInitialized() || (vAddr >> PageTable::VA_BITS) != 0)
+        return INVALID;
+
+    translations++;
+    size_t page = vAddr >> pageShift;
+    size_t offset = vAddr & (pageSize - 1);
+
+    // ---------- TLB ----------
+    size_t frame = 0;
+    size_t order = 0;
+    bool entryDirty = false;
+    const uint32_t probe = probeOrders();
+    for (size_t i = 0; i < tlbs.size(); i++) {
+        if (tlbs[i].lookup(asid, page, probe, frame, entryDirty, order)) {
+            info.tlbLevel = static_cast<int>(i);
+            break;
+        }
+    }
+
+    if (info.tlbLevel >= 0) {
+        hits++;
+
+        // refill the levels above the one that hit
+        int refill = info.tlbLevel;
+        if (write && !entryDirty) {
+            // first write through a clean entry: walk to set D, and the
+            // hitting level learns the new bit too
+            dirtyAssists++;
+            size_t walked;
+            *walk(page, walked) |= PageTable::DIRTY;
+            entryDirty = true;
+            refill++;
+        }
+        for (int i = 0; i < refill; i++)
+            tlbs[i].insert(asid, page, frame, entryDirty, order);
+
+        if (replacement == PageReplacement::LRU && newest != frame) {
+            unlink(frame);
+            linkNewest(frame);
+        }
+        return ((frame + (page & orderMask(order))) << pageShift) | offset;
+    }
+
+    // ---------- PAGE WALK ----------
+    uint64_t* entry = walk(page, order);
+    if (entry && (*entry & PageTable::PRESENT)) {
         hits++;
-        return pageTable[page] * pageSize + offset;
+    } else {
+        // ---------- PAGE FAULT ----------
+        info.fault = true;
+        pageFaults++;
+
+        const size_t huge = PageTable::LEVEL_BITS;
+        const bool hugeFits = table->supportsOrder(huge) &&
+                              static_cast<int>(huge) <= frames.getMaxOrder();
+        order = 0;
+        if (hugeMode == HugePageMode::FAULT && hugeFits &&
+            table->populated(page, huge) == 0) {
+            // a huge page only if a block is free: no eviction for it
+            frame = frames.allocateOrder(static_cast<int>(huge));
+            if (frame != static_cast<size_t>(-1)) {
+                usedFrames += static_cast<size_t>(1) << huge;
+                order = huge;
+                hugeFaults++;
+            } else {
+                hugeFallbacks++;
+            }
+        }
+
+        // the frame first: evicting may free nodes on this page's path
+        if (order == 0) {
+            frame = allocateFrames(0);
+            entry = &table->map(page);
+            *entry = PageTable::makeEntry(frame, PageTable::PRESENT);
+        } else {
+            entry = &table->mapHuge(page, order);
+            *entry = PageTable::makeEntry(
+                frame, PageTable::PRESENT | PageTable::HUGE);
+        }
+        mapFrames(frame, page & ~orderMask(order), order, entry);
+
+        if (order == 0 && hugeMode == HugePageMode::PROMOTE && hugeFits &&
+            table->populated(page, huge) == PageTable::FANOUT &&
+            collapse(page, huge, false)) {
+            size_t reads = 0;
+            entry = table->find(page, reads, order);
+        }
     }
 
-    pageFaults++;
+    *entry |= PageTable::ACCESSED;
+    if (write)
+        *entry |= PageTable::DIRTY;
 
-    if (pageTable.size() >= numFrames) {
-        size_t victim = fifo.front();
-        fifo.pop();
-        pageTable.erase(victim);
+    frame = PageTable::entryFrame(*entry);
+    for (Tlb& tlb : tlbs)
+        tlb.insert(asid, page, frame, (*entry & PageTable::DIRTY) != 0,
+                   order);
+
+    if (replacement == PageReplacement::LRU && newest != frame) {
+        unlink(frame);
+        linkNewest(frame);
     }
 
-    size_t frame = pageTable.size();
-    pageTable[page] = frame;
-    fifo.push(page);
+    return ((frame + (page & orderMask(order))) << pageShift) | offset;
+}
 
-    return frame * pageSize + offset;
+size_t VirtualMemory::translate(size_t vAddr) {
+    TranslateInfo info;
+    return translate(vAddr, false, info);
 }
 
+// ---------- Stats ----------
 void VirtualMemory::stats() const {
-    std::cout << "Page hits: " << hits << "\n";
-    std::cout << "Page faults: " << pageFaults << "\n";
+    if (!isInitialized()) {
+        std::cout << "Virtual memory not initialized\n";
+        return;
+    }
+
+    size_t mapped = 0;
+    size_t nodes = 0;
+    for (const auto& space : tables) {
+        mapped += space.second.getMappedPages();
+        nodes += space.second.getNodes();
+    }
+
+    double faultRate = (translations == 0)
+        ? 0.0
+        : (double)pageFaults / translations * 100.0;
+    double readsPerTranslation = (translations == 0)
+        ? 0.0
+        : (double)walkReads / translations;
+
+    std::cout << std::dec;
+    std::cout << "Virtual Memory Stats\n";
+    std::cout << "Page size     : " << pageSize << "\n";
+    std::cout << "Frames        : " << usedFrames << " / " << numFrames
+              << " used\n";
+    std::cout << "Address spaces: " << tables.size()
+              << " (current ASID " << asid << ")\n";
+    std::cout << "Page table    : " << table->getLevels() << " levels, "
+              << nodes << " nodes, " << mapped << " pages mapped\n";
+    std::cout << "Translations  : " << translations << "\n";
+    std::cout << "Page hits     : " << hits << "\n";
+    std::cout << "Page faults   : " << pageFaults << "\n";
+    std::cout << "Replacement   : " << pageReplacementName(replacement);
+    if (replacement == PageReplacement::WSCLOCK)
+        std::cout << " (tau " << tau << ")";
+    std::cout << "\n";
+    std::cout << "Evictions     : " << evictions
+              << " (" << dirtyEvictions << " dirty)\n";
+    if (cleanings > 0)
+        std::cout << "Cleanings     : " << cleanings << "\n";
+    std::cout << "Fault rate    : " << faultRate << "%\n";
+    std::cout << "Page walks    : " << walks << " (" << dirtyAssists
+              << " to set dirty bits)\n";
+    std::cout << "Walk reads    : " << walkReads << " ("
+              << readsPerTranslation << " per translation)\n";
+    std::cout << "Shootdowns    : " << shootdowns << "\n";
+
+    if (hugeMode != HugePageMode::OFF || hugeFaults > 0 || promotions > 0 ||
+        promotionFailures > 0 || demotions > 0) {
+        std::cout << "Huge pages    : " << hugePageModeName(hugeMode);
+        for (size_t i = 0; i < HUGE_ORDERS; i++)
+            std::cout << (i == 0 ? ", " : " + ") << hugeMapped[i] << " x "
+                      << sizeLabel(pageSize << (PageTable::LEVEL_BITS * (i + 1)));
+        std::cout << " mapped\n";
+        std::cout << "Huge faults   : " << hugeFaults << " ("
+                  << hugeFallbacks << " fell back to base pages)\n";
+        std::cout << "Promotions    : " << promotions << " (" << pagesCopied
+                  << " pages copied, " << promotionFailures
+                  << " found no free block)\n";
+        std::cout << "Demotions     : " << demotions << "\n";
+        std::cout << "Reads saved   : " << walkReadsSaved
+                  << " (walks ending at huge leaves)\n";
+
+        // how free frames are split up decides which huge pages fit
+        std::cout << "Free blocks   :";
+        bool any = false;
+        for (int order = frames.getMaxOrder(); order >= 0; order--) {
+            size_t count = frames.freeBlocks(order);
+            if (count == 0)
+                continue;
+            std::cout << (any ? ", " : " ") << sizeLabel(pageSize << order)
+                      << " x " << count;
+            any = true;
+        }
+        std::cout << (any ? "\n" : " none\n");
+    }
+
+    for (const Tlb& tlb : tlbs) {
+        std::cout << "\n";
+        tlb.stats(pageSize);
+    }
+}
+
+// ---------- Getters ----------
+size_t VirtualMemory::getPageSize() const {
+    return pageSize;
+}
+
+size_t VirtualMemory::getPhysSize() const {
+    return numFrames * pageSize;
+}
+
+size_t VirtualMemory::getTranslations() const {
+    return translations;
+}
+
+size_t VirtualMemory::getHits() const {
+    return hits;
+}
+
+size_t VirtualMemory::getPageFaults() const {
+    return pageFaults;
+}
+
+size_t VirtualMemory::getEvictions() const {
+    return evictions;
+}
+
+size_t VirtualMemory::getDirtyEvictions() const {
+    return dirtyEvictions;
+}
+
+size_t VirtualMemory::getCleanings() const {
+    return cleanings;
+}
+
+size_t VirtualMemory::getWalks() const {
+    return walks;
+}
+
+size_t VirtualMemory::getWalkReads() const {
+    return walkReads;
+}
+
+const PageTable& VirtualMemory::getPageTable() const {
+    return *table;
 }
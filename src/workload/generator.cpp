@@ -0,0 +1,359 @@
+#include "../../include/workload/generator.h"
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+
+// request sizes of the CLASSES distribution, smallest first
+static const size_t CLASS_SIZES[] = {
+    16, 32, 48, 64, 96, 128, 192, 256, 384, 512, 768, 1024,
+    2048, 4096, 8192, 16384, 32768, 65536
+};
+
+// ---------- Names ----------
+bool parseSizeDistribution(const std::string& text, SizeDistribution& out) {
+    if (text == "classes")          out = SizeDistribution::CLASSES;
+    else if (text == "powerlaw")    out = SizeDistribution::POWER_LAW;
+    else if (text == "bimodal")     out = SizeDistribution::BIMODAL;
+    else                            return false;
+    return true;
+}
+
+bool parseLifetimeModel(const std::string& text, LifetimeModel& out) {
+    if (text == "lifo")             out = LifetimeModel::LIFO;
+    else if (text == "fifo")        out = LifetimeModel::FIFO;
+    else if (text == "longlived")   out = LifetimeModel::LONG_LIVED;
+    else                            return false;
+    return true;
+}
+
+bool parseWorkloadPattern(const std::string& text, WorkloadPattern& out) {
+    if (text == "mixed")                    out = WorkloadPattern::MIXED;
+    else if (text == "producer-consumer")   out = WorkloadPattern::PRODUCER_CONSUMER;
+    else                                    return false;
+    return true;
+}
+
+const char* sizeDistributionName(SizeDistribution dist) {
+    switch (dist) {
+    case SizeDistribution::CLASSES:     return "classes";
+    case SizeDistribution::POWER_LAW:   return "powerlaw";
+    case SizeDistribution::BIMODAL:     return "bimodal";
+    }
+    return "?";
+}
+
+const char* lifetimeModelName(LifetimeModel model) {
+    switch (model) {
+    case LifetimeModel::LIFO:           return "lifo";
+    case LifetimeModel::FIFO:           return "fifo";
+    case LifetimeModel::LONG_LIVED:     return "longlived";
+    }
+    return "?";
+}
+
+const char* workloadPatternName(WorkloadPattern pattern) {
+    switch (pattern) {
+    case WorkloadPattern::MIXED:                return "mixed";
+    case WorkloadPattern::PRODUCER_CONSUMER:    return "producer-consumer";
+    }
+    return "?";
+}
+
+// ================= Configuration =================
+WorkloadConfig::WorkloadConfig()
+    : seed(1),
+      ops(1000000),
+      init(TraceOp::INIT_MEMORY),
+      heapSize(64 << 20),
+      allocator(AllocatorType::TLSF),
+      sizes(SizeDistribution::POWER_LAW),
+      minSize(16),
+      maxSize(4096),
+      alpha(1.2),
+      largeFraction(0.1),
+      lifetime(LifetimeModel::LONG_LIVED),
+      liveTarget(4096),
+      longLivedFraction(0.2),
+      pattern(WorkloadPattern::MIXED),
+      accessRatio(0.5),
+      writeRatio(0.3),
+      zipf(0.99),
+      footprint(0)
+{
+}
+
+// ================= Generator =================
+// std::max / std::min take them by reference
+const size_t WorkloadGenerator::LINE;
+const size_t WorkloadGenerator::MAX_MESSAGE_LINES;
+
+WorkloadGenerator::WorkloadGenerator(const WorkloadConfig& cfg)
+    : config(cfg),
+      state(cfg.seed),
+      setupPos(0),
+      produced(0),
+      liveBlocks(0),
+      permanentBlocks(0),
+      liveBytes(0),
+      peakLive(0),
+      peakLiveBytes(0),
+      nextId(1),
+      nextSlot(0),
+      pendingPos(0)
+{
+    if (config.footprint == 0)
+        config.footprint = config.heapSize;
+    config.minSize = std::max<size_t>(config.minSize, 1);
+    config.maxSize = std::max(config.maxSize, config.minSize);
+    config.liveTarget = std::max<size_t>(config.liveTarget, 1);
+
+    setup.push_back({config.init, config.heapSize});
+    if (config.init == TraceOp::INIT_MEMORY)
+        setup.push_back({TraceOp::SET_ALLOCATOR,
+                         static_cast<uint64_t>(config.allocator)});
+
+    sizeOf.push_back(0);    // ids start at 1
+
+    // producer-consumer: one slot of the footprint per queued message
+    slotBytes = config.footprint / config.liveTarget / LINE * LINE;
+    slotBytes = std::max(slotBytes, LINE);
+
+    // Zipf over the footprint's lines; consecutive ranks land far apart
+    lines = std::max<size_t>(config.footprint / LINE, 1);
+    stride = static_cast<size_t>(lines * 0.6180339887) | 1;
+    while (std::gcd(stride, lines) != 1)
+        stride += 2;
+
+    if (config.zipf > 0) {
+        hX1 = hIntegral(1.5) - 1.0;
+        hN = hIntegral(static_cast<double>(lines) + 0.5);
+        sConst = 2.0 - hIntegralInverse(hIntegral(2.5) - h(2.0));
+    } else {
+        hX1 = hN = sConst = 0;
+    }
+}
+
+// ---------- Randomness ----------
+// splitmix64
+uint64_t WorkloadGenerator::nextRandom() {
+    uint64_t z = (state += 0x9e3779b97f4a7c15ull);
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+    return z ^ (z >> 31);
+}
+
+double WorkloadGenerator::uniform() {
+    return (nextRandom() >> 11) * 0x1.0p-53;
+}
+
+size_t WorkloadGenerator::below(size_t n) {
+    return static_cast<size_t>(
+        (static_cast<unsigned __int128>(nextRandom()) * n) >> 64);
+}
+
+// ---------- Sizes ----------
+size_t WorkloadGenerator::drawSize() {
+    size_t lo = config.minSize;
+    size_t hi = config.maxSize;
+
+    switch (config.sizes) {
+    case SizeDistribution::CLASSES: {
+        // classes inside [lo, hi]; each step up is half as likely
+        const size_t* first = std::lower_bound(
+            std::begin(CLASS_SIZES), std::end(CLASS_SIZES), lo);
+        const size_t* last = std::upper_bound(
+            std::begin(CLASS_SIZES), std::end(CLASS_SIZES), hi);
+        if (first == last)
+            return lo;
+        const size_t* pick = first;
+        while (pick + 1 < last && (nextRandom() & 1))
+            pick++;
+        return *pick;
+    }
+    case SizeDistribution::POWER_LAW: {
+        // inverse CDF of the Pareto distribution bounded to [lo, hi]
+        double ratio = std::pow(static_cast<double>(lo) / hi, config.alpha);
+        double x = lo / std::pow(1.0 - uniform() * (1.0 - ratio),
+                                 1.0 / config.alpha);
+        return std::min(hi, std::max(lo, static_cast<size_t>(x)));
+    }
+    case SizeDistribution::BIMODAL: {
+        if (uniform() < config.largeFraction) {
+            size_t from = std::max(lo, hi / 2);
+            return from + below(hi - from + 1);
+        }
+        size_t to = std::min(hi, lo * 4);
+        return lo + below(to - lo + 1);
+    }
+    }
+    return lo;
+}
+
+// ---------- Zipf ----------
+// Rejection-inversion sampling (Hormann and Derflinger): O(1) per draw
+// and no table, whatever the number of lines.
+double WorkloadGenerator::h(double x) const {
+    return std::exp(-config.zipf * std::log(x));
+}
+
+double WorkloadGenerator::hIntegral(double x) const {
+    double logX = std::log(x);
+    double t = (1.0 - config.zipf) * logX;
+    double ratio = std::abs(t) > 1e-8 ? std::expm1(t) / t
+                                      : 1.0 + t * 0.5 * (1.0 + t / 3.0);
+    return ratio * logX;
+}
+
+double WorkloadGenerator::hIntegralInverse(double x) const {
+    double t = std::max(x * (1.0 - config.zipf), -1.0);
+    double ratio = std::abs(t) > 1e-8 ? std::log1p(t) / t
+                                      : 1.0 - t * (0.5 - t / 3.0);
+    return std::exp(ratio * x);
+}
+
+size_t WorkloadGenerator::drawLine() {
+    if (config.zipf <= 0)
+        return below(lines);
+
+    size_t rank;
+    while (true) {
+        double u = hN + uniform() * (hX1 - hN);
+        double x = hIntegralInverse(u);
+        double k = std::floor(x + 0.5);
+        k = std::min(std::max(k, 1.0), static_cast<double>(lines));
+        if (k - x <= sConst || u >= hIntegral(k + 0.5) - h(k)) {
+            rank = static_cast<size_t>(k) - 1;
+            break;
+        }
+    }
+    return static_cast<size_t>(
+        (static_cast<unsigned __int128>(rank) * stride) % lines);
+}
+
+// ---------- Operations ----------
+int WorkloadGenerator::allocate(TraceRecord& record, size_t size) {
+    sizeOf.push_back(size);
+    liveBlocks++;
+    liveBytes += size;
+    peakLive = std::max(peakLive, liveBlocks);
+    peakLiveBytes = std::max(peakLiveBytes, liveBytes);
+    record = {TraceOp::MALLOC, size};
+    return nextId++;
+}
+
+void WorkloadGenerator::release(TraceRecord& record, int id) {
+    liveBlocks--;
+    liveBytes -= sizeOf[id];
+    record = {TraceOp::FREE, static_cast<uint64_t>(id)};
+}
+
+void WorkloadGenerator::mixedOp(TraceRecord& record) {
+    if (uniform() < config.accessRatio) {
+        TraceOp op = uniform() < config.writeRatio ? TraceOp::WRITE
+                                                   : TraceOp::READ;
+        record = {op, drawLine() * LINE};
+        return;
+    }
+
+    // grow towards the target, then hover around it
+    bool grow = live.empty() ||
+                (liveBlocks < config.liveTarget && uniform() < 0.6);
+    if (grow) {
+        int id = allocate(record, drawSize());
+
+        // long-lived blocks are never freed, up to their share of the
+        // target
+        bool keep = config.lifetime == LifetimeModel::LONG_LIVED &&
+                    permanentBlocks <
+                        config.longLivedFraction * config.liveTarget &&
+                    uniform() < config.longLivedFraction;
+        if (keep)
+            permanentBlocks++;
+        else
+            live.push_back(id);
+        return;
+    }
+
+    int id;
+    if (config.lifetime == LifetimeModel::LIFO) {
+        id = live.back();
+        live.pop_back();
+    } else if (config.lifetime == LifetimeModel::FIFO) {
+        id = live.front();
+        live.pop_front();
+    } else {
+        size_t i = below(live.size());
+        id = live[i];
+        live[i] = live.back();
+        live.pop_back();
+    }
+    release(record, id);
+}
+
+void WorkloadGenerator::producerConsumerOp(TraceRecord& record) {
+    size_t depth = config.liveTarget;
+    bool produce = queue.empty() ||
+                   (queue.size() < depth && uniform() < 0.5);
+    pending.clear();
+    pendingPos = 0;
+
+    if (produce) {
+        // malloc the message, then write it into its slot
+        size_t size = drawSize();
+        Message message{allocate(record, size), nextSlot++ % depth, 0};
+        message.lines = std::min({(size + LINE - 1) / LINE,
+                                  MAX_MESSAGE_LINES, slotBytes / LINE});
+        queue.push_back(message);
+
+        size_t base = message.slot * slotBytes;
+        for (size_t i = 0; i < message.lines; i++)
+            pending.push_back({TraceOp::WRITE, base + i * LINE});
+        return;
+    }
+
+    // read the oldest message back, then free it
+    Message message = queue.front();
+    queue.pop_front();
+    size_t base = message.slot * slotBytes;
+    for (size_t i = 0; i < message.lines; i++)
+        pending.push_back({TraceOp::READ, base + i * LINE});
+
+    TraceRecord free;
+    release(free, message.id);
+    pending.push_back(free);
+
+    record = pending[0];
+    pendingPos = 1;
+}
+
+bool WorkloadGenerator::next(TraceRecord& record) {
+    if (setupPos < setup.size()) {
+        record = setup[setupPos++];
+        return true;
+    }
+    if (produced == config.ops)
+        return false;
+    produced++;
+
+    if (pendingPos < pending.size()) {
+        record = pending[pendingPos++];
+        return true;
+    }
+    if (config.pattern == WorkloadPattern::PRODUCER_CONSUMER)
+        producerConsumerOp(record);
+    else
+        mixedOp(record);
+    return true;
+}
+
+size_t WorkloadGenerator::getLive() const {
+    return liveBlocks;
+}
+
+size_t WorkloadGenerator::getPeakLive() const {
+    return peakLive;
+}
+
+size_t WorkloadGenerator::getPeakLiveBytes() const {
+    return peakLiveBytes;
+}
@@ -6,17 +6,133 @@ echo "=== Memory Basic ==="
 echo "=== Fragmentation ==="
 ./memsim < tests/memory_fragmentation.txt
 
+echo "=== Dump Then Stats ==="
+./memsim < tests/dump_stats.txt
+
 echo "=== Fit Strategies ==="
 ./memsim < tests/fit_strategies.txt
 
+echo "=== TLSF Allocator ==="
+./memsim < tests/tlsf_basic.txt
+
 echo "=== Buddy Allocator ==="
 ./memsim < tests/buddy_basic.txt
 
+echo "=== Buddy Invalid Input ==="
+./memsim < tests/buddy_invalid.txt
+
+echo "=== Lazy Buddy ==="
+./memsim < tests/buddy_lazy.txt
+
+echo "=== Slab Allocator ==="
+./memsim < tests/slab_basic.txt
+
 echo "=== Cache Sequential ==="
 ./memsim < tests/cache_sequential.txt
 
 echo "=== Cache Conflict ==="
 ./memsim < tests/cache_conflict.txt
 
+echo "=== Cache Policies ==="
+./memsim < tests/cache_policies.txt
+
+echo "=== Cache Hierarchy ==="
+./memsim < tests/cache_hierarchy.txt
+
+echo "=== Cache Curve ==="
+./memsim < tests/cache_curve.txt
+
+echo "=== Cache Prefetch ==="
+./memsim < tests/cache_prefetch.txt
+
+echo "=== Multicore MESI ==="
+./memsim < tests/multicore.txt
+
+echo "=== Virtual Memory ==="
+./memsim < tests/vm_basic.txt
+
+echo "=== TLB ==="
+./memsim < tests/vm_tlb.txt
+
+echo "=== Page Replacement ==="
+./memsim < tests/vm_paging.txt
+
+echo "=== Huge Pages ==="
+./memsim < tests/vm_huge.txt
+
+echo "=== Binary Trace Replay ==="
+trace=$(mktemp)
+./memsim --convert tests/tlsf_basic.txt "$trace" && ./memsim --replay "$trace"
+./memsim --convert tests/cache_conflict.txt "$trace" --delta && ./memsim --replay "$trace"
+# hand-made records with arguments their commands cannot take: both
+# replays stop as corrupt instead of freeing block 1 / setting allocator 9
+header='MSTR\x01\x00\x00\x00\x03\x00\x00\x00\x00\x00\x00\x00'
+init='\x00\x10\x00\x00\x00\x00\x00\x01'
+printf "$header$init"'\x40\x00\x00\x00\x00\x00\x00\x06\x01\x00\x00\x00\x01\x00\x00\x07' > "$trace"
+./memsim --replay "$trace" | grep -v " ms ("
+printf "$header$init"'\x09\x00\x00\x00\x00\x00\x00\x05' > "$trace"
+./memsim --replay "$trace" | grep -v " ms ("
+rm -f "$trace"
+
+echo "=== Batch Output Modes ==="
+./memsim --batch < tests/buddy_lazy.txt
+./memsim --counts < tests/memory_cache_mix.txt
+trace=$(mktemp)
+./memsim --convert tests/slab_basic.txt "$trace" && ./memsim --quiet --replay "$trace"
+rm -f "$trace"
+
+echo "=== JSON Protocol ==="
+./memsim --json < tests/json_events.txt
+
+echo "=== Streamed Trace ==="
+./memsim < tests/vm_stream.txt
+packed=$(mktemp --suffix=.gz)
+gzip -c tests/access_trace.txt > "$packed"
+printf 'stream %s\nexit\n' "$packed" | ./memsim
+rm -f "$packed"
+
+echo "=== Batched Cache Replay ==="
+# one plain cache level without VM: stream replays it with accessBatch,
+# which must match the single-threaded run exactly
+accesses=$(mktemp)
+awk 'BEGIN { x = 1; for (i = 0; i < 300000; i++) {
+    x = (x * 69069 + 1) % 4294967296
+    printf "%s 0x%x\n", (int(x / 65536) % 4 ? "r" : "w"), int(x / 4096) % 65536 } }' > "$accesses"
+for threads in 1 4; do
+    sed "s|TRACE|$accesses|; s|THREADS|$threads|" tests/cache_batch.txt |
+        ./memsim | grep -v " ms (" > "$accesses.$threads"
+done
+cat "$accesses.4"
+cmp -s "$accesses.1" "$accesses.4" && echo "Batched and serial replay match" ||
+    echo "Batched and serial replay differ"
+rm -f "$accesses.1" "$accesses.4"
+
+echo "=== AVX2 Tag Compare ==="
+# runtime way counts (6, 12 and 5 ways) take the SIMD tag compare; the
+# -mavx2 build must give exactly the SSE2 build's results
+if grep -qw avx2 /proc/cpuinfo; then
+    for sim in memsim memsim-avx2; do
+        sed "s|TRACE|$accesses|" tests/cache_simd.txt |
+            ./$sim | grep -v " ms (" > "$accesses.$sim"
+        ./$sim < tests/cache_hierarchy.txt >> "$accesses.$sim"
+    done
+    cat "$accesses.memsim-avx2"
+    cmp -s "$accesses.memsim" "$accesses.memsim-avx2" &&
+        echo "AVX2 and SSE2 tag compares match" ||
+        echo "AVX2 and SSE2 tag compares differ"
+else
+    echo "No AVX2 on this CPU: skipped"
+fi
+rm -f "$accesses" "$accesses.memsim" "$accesses.memsim-avx2"
+
+echo "=== Synthetic Workloads ==="
+./memsim --counts gen --ops 20000 --seed 7
+./memsim --counts gen --ops 50000 --heap 64k
+./memsim --quiet gen --pattern producer-consumer --allocator buddy --heap 1m --live 64 --ops 20000
+trace=$(mktemp)
+./memsim gen --allocator slab --sizes classes --lifetime fifo --ops 20000 -o "$trace" --delta &&
+    ./memsim --quiet --replay "$trace"
+rm -f "$trace"
+
 echo "=== Mixed Workload ==="
 ./memsim < tests/memory_cache_mix.txt